@@ -0,0 +1,246 @@
+#include "base_binary.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "mapped_file.h"
+
+using namespace std::string_literals;
+
+namespace base_binary {
+
+	using namespace transport_catalogue;
+
+	namespace {
+		constexpr char SIGNATURE[4] = { 'T', 'C', 'B', 'B' };
+		constexpr uint32_t VERSION = 1;
+		constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+		constexpr size_t ALIGNMENT = 8;
+
+		struct Header {
+			char signature[4];
+			uint32_t version;
+			uint32_t byte_order;
+			uint32_t stops_count;
+			uint32_t buses_count;
+			uint32_t reserved;
+			uint64_t distances_count;
+			uint64_t route_stops_count;
+			uint64_t names_size;
+		};
+
+		size_t AlignUp(size_t size) {
+			return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+		}
+
+		uint32_t CheckedUint32(size_t value, const char* what) {
+			if (value > std::numeric_limits<uint32_t>::max()) {
+				throw FormatError("Too many "s + what + " for binary base"s);
+			}
+			return static_cast<uint32_t>(value);
+		}
+
+		template <typename T>
+		void WriteSection(std::ostream& output, const std::vector<T>& values) {
+			const size_t size = values.size() * sizeof(T);
+			output.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(size));
+			static const char padding[ALIGNMENT] = {};
+			output.write(padding, static_cast<std::streamsize>(AlignUp(size) - size));
+		}
+
+		// Последовательное чтение разделов с проверкой границ
+		class SectionReader {
+		public:
+			explicit SectionReader(std::string_view data)
+				: data_(data) {
+			}
+
+			std::string_view Take(size_t size) {
+				if (size > data_.size() - pos_) {
+					throw FormatError("Binary base is truncated"s);
+				}
+				const std::string_view section = data_.substr(pos_, size);
+				pos_ = std::min(data_.size(), pos_ + AlignUp(size));
+				return section;
+			}
+
+			template <typename T>
+			std::vector<T> ReadArray(uint64_t count) {
+				if (count > (data_.size() - pos_) / sizeof(T)) {
+					throw FormatError("Binary base is truncated"s);
+				}
+				std::vector<T> values(static_cast<size_t>(count));
+				const std::string_view section = Take(values.size() * sizeof(T));
+				std::memcpy(values.data(), section.data(), section.size());
+				return values;
+			}
+
+		private:
+			std::string_view data_;
+			size_t pos_ = 0;
+		};
+
+		// Смещения должны не убывать и занимать ровно отрезок [first, last]
+		void CheckOffsets(const std::vector<uint32_t>& offsets, uint64_t first, uint64_t last, const char* what) {
+			if (offsets.front() != first || offsets.back() != last
+				|| !std::is_sorted(offsets.begin(), offsets.end())) {
+				throw FormatError("Invalid "s + what + " offsets in binary base"s);
+			}
+		}
+	} // namespace
+
+	void WriteBase(const TransportCatalogue& catalogue, std::ostream& output) {
+		const auto& stops = catalogue.GetAllStops();
+		const auto& buses = catalogue.GetAllBuses();
+
+		std::string names;
+		std::vector<uint32_t> stop_name_offsets{ 0 };
+		std::vector<double> coordinates;
+		coordinates.reserve(stops.size() * 2);
+		for (const Stop& stop : stops) {
+			names += stop.stop_name;
+			stop_name_offsets.push_back(CheckedUint32(names.size(), "names"));
+			coordinates.push_back(stop.position.lat);
+			coordinates.push_back(stop.position.lng);
+		}
+
+		std::vector<uint32_t> bus_name_offsets{ stop_name_offsets.back() };
+		std::vector<uint32_t> route_stop_offsets{ 0 };
+		std::vector<uint8_t> roundtrip_flags;
+		std::vector<uint32_t> route_stops;
+		for (const Bus& bus : buses) {
+			names += bus.bus_name;
+			bus_name_offsets.push_back(CheckedUint32(names.size(), "names"));
+			for (const Stop* stop : bus.bus_stops) {
+				route_stops.push_back(static_cast<uint32_t>(stop->stop_id));
+			}
+			route_stop_offsets.push_back(CheckedUint32(route_stops.size(), "route stops"));
+			roundtrip_flags.push_back(bus.is_circular ? 1 : 0);
+		}
+
+		// Упорядочиваем расстояния, чтобы файл не зависел от порядка хеш-таблицы
+		std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> sorted_distances;
+		sorted_distances.reserve(catalogue.GetAllDistances().size());
+		for (const auto& [stops_pair, distance] : catalogue.GetAllDistances()) {
+			sorted_distances.emplace_back(static_cast<uint32_t>(stops_pair.first->stop_id),
+				static_cast<uint32_t>(stops_pair.second->stop_id), distance);
+		}
+		std::sort(sorted_distances.begin(), sorted_distances.end());
+		std::vector<uint32_t> distances;
+		distances.reserve(sorted_distances.size() * 3);
+		for (const auto& [from, to, distance] : sorted_distances) {
+			distances.insert(distances.end(), { from, to, distance });
+		}
+
+		Header header{};
+		std::memcpy(header.signature, SIGNATURE, sizeof(SIGNATURE));
+		header.version = VERSION;
+		header.byte_order = BYTE_ORDER_MARK;
+		header.stops_count = CheckedUint32(stops.size(), "stops");
+		header.buses_count = CheckedUint32(buses.size(), "buses");
+		header.distances_count = sorted_distances.size();
+		header.route_stops_count = route_stops.size();
+		header.names_size = names.size();
+		output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		WriteSection(output, stop_name_offsets);
+		WriteSection(output, bus_name_offsets);
+		WriteSection(output, coordinates);
+		WriteSection(output, distances);
+		WriteSection(output, route_stop_offsets);
+		WriteSection(output, roundtrip_flags);
+		WriteSection(output, route_stops);
+		WriteSection(output, std::vector<char>(names.begin(), names.end()));
+
+		if (!output) {
+			throw std::runtime_error("Failed to write binary base"s);
+		}
+	}
+
+	namespace {
+
+		// source — описание источника для сообщений об ошибках
+		void LoadBuffer(std::shared_ptr<const void> owner, std::string_view data, const std::string& source,
+			TransportCatalogue& catalogue) {
+			SectionReader reader(data);
+
+			Header header;
+			std::memcpy(&header, reader.Take(sizeof(header)).data(), sizeof(header));
+			if (std::memcmp(header.signature, SIGNATURE, sizeof(SIGNATURE)) != 0) {
+				throw FormatError(source + " is not a binary base"s);
+			}
+			if (header.byte_order != BYTE_ORDER_MARK) {
+				throw FormatError("Binary base was written with a different byte order"s);
+			}
+			if (header.version != VERSION) {
+				throw FormatError("Unsupported binary base version "s + std::to_string(header.version));
+			}
+
+			const auto stop_name_offsets = reader.ReadArray<uint32_t>(uint64_t{ header.stops_count } + 1);
+			const auto bus_name_offsets = reader.ReadArray<uint32_t>(uint64_t{ header.buses_count } + 1);
+			const auto coordinates = reader.ReadArray<double>(uint64_t{ header.stops_count } * 2);
+			const auto distances = reader.ReadArray<uint32_t>(header.distances_count * 3);
+			const auto route_stop_offsets = reader.ReadArray<uint32_t>(uint64_t{ header.buses_count } + 1);
+			const auto roundtrip_flags = reader.ReadArray<uint8_t>(header.buses_count);
+			const auto route_stops = reader.ReadArray<uint32_t>(header.route_stops_count);
+			const std::string_view names = reader.Take(header.names_size);
+
+			CheckOffsets(stop_name_offsets, 0, bus_name_offsets.front(), "stop name");
+			CheckOffsets(bus_name_offsets, stop_name_offsets.back(), header.names_size, "bus name");
+			CheckOffsets(route_stop_offsets, 0, header.route_stops_count, "route stop");
+			const auto is_stop_index = [&header](uint32_t index) {
+				return index < header.stops_count;
+			};
+			if (!std::all_of(route_stops.begin(), route_stops.end(), is_stop_index)) {
+				throw FormatError("Invalid stop index in binary base"s);
+			}
+
+			std::vector<StopDescription> stop_descriptions(header.stops_count);
+			for (size_t i = 0; i < stop_descriptions.size(); ++i) {
+				stop_descriptions[i] = {
+					names.substr(stop_name_offsets[i], stop_name_offsets[i + 1] - stop_name_offsets[i]),
+					{ coordinates[i * 2], coordinates[i * 2 + 1] }
+				};
+			}
+
+			std::vector<IndexedDistanceDescription> distance_descriptions(static_cast<size_t>(header.distances_count));
+			for (size_t i = 0; i < distance_descriptions.size(); ++i) {
+				distance_descriptions[i] = { distances[i * 3], distances[i * 3 + 1], distances[i * 3 + 2] };
+				if (!is_stop_index(distance_descriptions[i].from) || !is_stop_index(distance_descriptions[i].to)) {
+					throw FormatError("Invalid stop index in binary base"s);
+				}
+			}
+
+			std::vector<IndexedBusDescription> bus_descriptions;
+			bus_descriptions.reserve(header.buses_count);
+			for (size_t i = 0; i < header.buses_count; ++i) {
+				bus_descriptions.push_back({
+					names.substr(bus_name_offsets[i], bus_name_offsets[i + 1] - bus_name_offsets[i]),
+					{ route_stops.data() + route_stop_offsets[i], route_stops.data() + route_stop_offsets[i + 1] },
+					roundtrip_flags[i] != 0
+					});
+			}
+
+			catalogue.AddNameSource(std::move(owner), data);
+			catalogue.AddBase(stop_descriptions, distance_descriptions, bus_descriptions);
+		}
+
+	} // namespace
+
+	void LoadBase(const std::string& path, TransportCatalogue& catalogue) {
+		auto file = std::make_shared<const mapped_file::MappedFile>(path);
+		LoadBuffer(file, file->GetData(), "'"s + path + "'"s, catalogue);
+	}
+
+	void LoadBase(std::istream& input, TransportCatalogue& catalogue) {
+		auto buffer = std::make_shared<const std::string>(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+		LoadBuffer(buffer, *buffer, "Input"s, catalogue);
+	}
+
+} // namespace base_binary
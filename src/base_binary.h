@@ -0,0 +1,44 @@
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+#include "transport_catalogue.h"
+
+namespace base_binary {
+
+	// Двоичный формат базы: таблица названий, массивы координат, расстояний
+	// и номеров остановок маршрутов. Загружается без разбора текста: массивы
+	// передаются в справочник напрямую, названия не копируются.
+	// Числа записываются в порядке байтов машины, файл с другим порядком отвергается
+	//
+	// Заголовок: сигнатура "TCBB", версия, метка порядка байтов, размеры разделов.
+	// Разделы (каждый выровнен на 8 байт):
+	//   смещения названий остановок   uint32[stops + 1]
+	//   смещения названий маршрутов   uint32[buses + 1]
+	//   координаты остановок          double[stops * 2] (широта, долгота)
+	//   расстояния                    uint32[distances * 3] (откуда, куда, метры)
+	//   смещения остановок маршрутов  uint32[buses + 1]
+	//   признаки кольцевых маршрутов  uint8[buses]
+	//   остановки маршрутов           uint32[route_stops]
+	//   названия                      char[names_size]
+
+	class FormatError : public std::runtime_error {
+	public:
+		using runtime_error::runtime_error;
+	};
+
+	// Записывает остановки, расстояния и маршруты справочника
+	void WriteBase(const transport_catalogue::TransportCatalogue& catalogue, std::ostream& output);
+
+	// Отображает файл в память и добавляет его содержимое в справочник.
+	// Справочник хранит названия как представления файла и продлевает его жизнь
+	void LoadBase(const std::string& path, transport_catalogue::TransportCatalogue& catalogue);
+
+	// Читает базу из потока в собственный буфер справочника. Подходит, когда файл
+	// может быть изменён на месте, пока справочник используется
+	void LoadBase(std::istream& input, transport_catalogue::TransportCatalogue& catalogue);
+
+} // namespace base_binary
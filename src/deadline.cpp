@@ -0,0 +1,55 @@
+#include "deadline.h"
+
+#include <algorithm>
+
+using namespace std::literals;
+
+namespace deadline {
+
+	DeadlineExceeded::DeadlineExceeded()
+		: std::runtime_error("timeout"s) {
+	}
+
+	Deadline::Deadline(Clock::time_point time)
+		: time_(time) {
+	}
+
+	Deadline Deadline::After(Clock::duration budget) {
+		return Deadline(Clock::now() + budget);
+	}
+
+	Deadline Deadline::Earliest(const Deadline& other) const {
+		if (!time_) {
+			return other;
+		}
+		if (!other.time_) {
+			return *this;
+		}
+		return Deadline(std::min(*time_, *other.time_));
+	}
+
+	bool Deadline::IsLimited() const {
+		return time_.has_value();
+	}
+
+	std::optional<Deadline::Clock::time_point> Deadline::GetTime() const {
+		return time_;
+	}
+
+	bool Deadline::IsExpired() const {
+		return time_ && Clock::now() >= *time_;
+	}
+
+	void Deadline::Check() const {
+		if (time_ && ++checks_count_ % CHECK_INTERVAL == 0) {
+			CheckNow();
+		}
+	}
+
+	void Deadline::CheckNow() const {
+		if (IsExpired()) {
+			throw DeadlineExceeded();
+		}
+	}
+
+} // namespace deadline
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+
+namespace deadline {
+
+	// Бросается, когда время на обработку запроса истекло
+	class DeadlineExceeded : public std::runtime_error {
+	public:
+		DeadlineExceeded();
+	};
+
+	// Момент, после которого обработку следует прервать.
+	// Объект по умолчанию не ограничивает время.
+	// Check читает часы лишь раз в CHECK_INTERVAL вызовов, поэтому подходит для внутренних циклов;
+	// счётчик вызовов не синхронизирован, и объект не следует разделять между потоками
+	class Deadline {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		static constexpr uint32_t CHECK_INTERVAL = 256;
+
+		Deadline() = default;
+		explicit Deadline(Clock::time_point time);
+		static Deadline After(Clock::duration budget);
+
+		// Более ранний из двух сроков
+		Deadline Earliest(const Deadline& other) const;
+		bool IsLimited() const;
+		std::optional<Clock::time_point> GetTime() const;
+		bool IsExpired() const;
+
+		void Check() const;
+		void CheckNow() const;
+
+	private:
+		std::optional<Clock::time_point> time_;
+		mutable uint32_t checks_count_ = 0;
+	};
+
+} // namespace deadline
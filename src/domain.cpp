@@ -10,4 +10,86 @@
  *
  * Если структура вашего приложения не позволяет так сделать, просто оставьте этот файл пустым.
  *
- */
\ No newline at end of file
+ */
+
+namespace domain {
+
+    // ===== class RouteView =====
+
+    RouteView::RouteView(const std::vector<const Stop*>& stops, bool is_circular)
+        : stops_(stops)
+        , is_circular_(is_circular) {
+    }
+
+    size_t RouteView::size() const {
+        if (is_circular_ || stops_.empty()) {
+            return stops_.size();
+        }
+        return stops_.size() * 2 - 1;
+    }
+
+    bool RouteView::empty() const {
+        return stops_.empty();
+    }
+
+    const Stop* RouteView::operator[](size_t index) const {
+        if (index < stops_.size()) {
+            return stops_[index];
+        }
+        // Обратный путь некольцевого маршрута
+        return stops_[stops_.size() * 2 - 2 - index];
+    }
+
+    const Stop* RouteView::front() const {
+        return stops_.front();
+    }
+
+    const Stop* RouteView::back() const {
+        return (*this)[size() - 1];
+    }
+
+    RouteView::Iterator RouteView::begin() const {
+        return Iterator(this, 0);
+    }
+
+    RouteView::Iterator RouteView::end() const {
+        return Iterator(this, size());
+    }
+
+    // ===== class RouteView::Iterator =====
+
+    RouteView::Iterator::Iterator(const RouteView* route, size_t index)
+        : route_(route)
+        , index_(index) {
+    }
+
+    RouteView::Iterator::reference RouteView::Iterator::operator*() const {
+        return (*route_)[index_];
+    }
+
+    RouteView::Iterator& RouteView::Iterator::operator++() {
+        ++index_;
+        return *this;
+    }
+
+    RouteView::Iterator RouteView::Iterator::operator++(int) {
+        Iterator prev = *this;
+        ++index_;
+        return prev;
+    }
+
+    bool RouteView::Iterator::operator==(const Iterator& other) const {
+        return route_ == other.route_ && index_ == other.index_;
+    }
+
+    bool RouteView::Iterator::operator!=(const Iterator& other) const {
+        return !(*this == other);
+    }
+
+    // ===== struct Bus =====
+
+    RouteView Bus::GetRoute() const {
+        return RouteView(bus_stops, is_circular);
+    }
+
+} // namespace domain
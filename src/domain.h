@@ -1,20 +1,66 @@
 #pragma once
 
+#include <iterator>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "geo.h"
 
 namespace domain {
 
     struct Stop {
-        std::string stop_name;
+        std::string_view stop_name; // строка хранится в справочнике
         geo::Coordinates position;
+        size_t stop_id = 0; // порядковый номер, назначается справочником
+    };
+
+    // Полный порядок прохождения остановок маршрутом без копирования.
+    // Для некольцевого маршрута A-B-C выдаёт A-B-C-B-A
+    class RouteView {
+    public:
+        class Iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = const Stop*;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const value_type*;
+            using reference = value_type;
+
+            Iterator(const RouteView* route, size_t index);
+
+            reference operator*() const;
+            Iterator& operator++();
+            Iterator operator++(int);
+            bool operator==(const Iterator& other) const;
+            bool operator!=(const Iterator& other) const;
+
+        private:
+            const RouteView* route_;
+            size_t index_;
+        };
+
+        RouteView(const std::vector<const Stop*>& stops, bool is_circular);
+
+        size_t size() const;
+        bool empty() const;
+        const Stop* operator[](size_t index) const;
+        const Stop* front() const;
+        const Stop* back() const;
+        Iterator begin() const;
+        Iterator end() const;
+
+    private:
+        const std::vector<const Stop*>& stops_;
+        bool is_circular_;
     };
 
     struct Bus {
-        std::string bus_name;
-        std::vector<const Stop*> bus_stops;
+        std::string_view bus_name; // строка хранится в справочнике
+        std::vector<const Stop*> bus_stops; // остановки в том виде, как они заданы
         bool is_circular;
+
+        // Остановки в порядке прохождения, включая обратный путь некольцевого маршрута
+        RouteView GetRoute() const;
     };
 
     struct BusInfo {
@@ -25,4 +71,4 @@ namespace domain {
         bool bus_found = false;
     };
 
-} // namespace domain
\ No newline at end of file
+} // namespace domain
@@ -1,11 +1,65 @@
 #define _USE_MATH_DEFINES
 #include "geo.h"
 
+#include <algorithm>
+#include <cassert>
 #include <cmath>
 
 constexpr int EARTH_RADIUS_M = 6371000;
 
 namespace geo {
+
+    namespace {
+
+        constexpr double DR = M_PI / 180.0;
+        constexpr size_t PATH_CHUNK_SIZE = 64;
+
+        // Точки, заданные указателями на начала массивов структуры CoordinatesBatch
+        struct PointsView {
+            const double* lat;
+            const double* lng;
+            const double* sin_lat;
+            const double* cos_lat;
+        };
+
+        // Циклы без ветвлений и зависимостей между итерациями,
+        // чтобы компилятор мог их векторизовать
+        void ComputeCosinesDistances(PointsView from, PointsView to, size_t count, double* distances) {
+            for (size_t i = 0; i < count; ++i) {
+                const double cos_angle = from.sin_lat[i] * to.sin_lat[i]
+                    + from.cos_lat[i] * to.cos_lat[i] * std::cos(std::abs(from.lng[i] - to.lng[i]) * DR);
+                const double distance = std::acos(std::min(cos_angle, 1.0)) * EARTH_RADIUS_M;
+                const bool same_point = from.lat[i] == to.lat[i] && from.lng[i] == to.lng[i];
+                distances[i] = same_point ? 0.0 : distance;
+            }
+        }
+
+        void ComputeHaversineDistances(PointsView from, PointsView to, size_t count, double* distances) {
+            for (size_t i = 0; i < count; ++i) {
+                const double sin_half_lat = std::sin((to.lat[i] - from.lat[i]) * DR / 2);
+                const double sin_half_lng = std::sin((to.lng[i] - from.lng[i]) * DR / 2);
+                const double h = sin_half_lat * sin_half_lat
+                    + from.cos_lat[i] * to.cos_lat[i] * sin_half_lng * sin_half_lng;
+                distances[i] = 2.0 * std::asin(std::min(std::sqrt(h), 1.0)) * EARTH_RADIUS_M;
+            }
+        }
+
+        void ComputeDistancesImpl(PointsView from, PointsView to, size_t count,
+            double* distances, DistanceFormula formula) {
+            if (formula == DistanceFormula::HAVERSINE) {
+                ComputeHaversineDistances(from, to, count, distances);
+            }
+            else {
+                ComputeCosinesDistances(from, to, count, distances);
+            }
+        }
+
+        PointsView Shift(PointsView points, size_t offset) {
+            return { points.lat + offset, points.lng + offset,
+                points.sin_lat + offset, points.cos_lat + offset };
+        }
+
+    } // namespace
     
     bool Coordinates::operator==(const Coordinates& other) const {
         return lat == other.lat && lng == other.lng;
@@ -25,4 +79,75 @@ namespace geo {
             * EARTH_RADIUS_M;
     }
 
-}  // namespace geo
\ No newline at end of file
+    // ===== class CoordinatesBatch =====
+
+    void CoordinatesBatch::Reserve(size_t count) {
+        lat_.reserve(count);
+        lng_.reserve(count);
+        sin_lat_.reserve(count);
+        cos_lat_.reserve(count);
+    }
+
+    void CoordinatesBatch::Clear() {
+        lat_.clear();
+        lng_.clear();
+        sin_lat_.clear();
+        cos_lat_.clear();
+    }
+
+    void CoordinatesBatch::Add(Coordinates coords) {
+        lat_.push_back(coords.lat);
+        lng_.push_back(coords.lng);
+        sin_lat_.push_back(std::sin(coords.lat * DR));
+        cos_lat_.push_back(std::cos(coords.lat * DR));
+    }
+
+    void CoordinatesBatch::Add(const CoordinatesBatch& other, size_t index) {
+        lat_.push_back(other.lat_[index]);
+        lng_.push_back(other.lng_[index]);
+        sin_lat_.push_back(other.sin_lat_[index]);
+        cos_lat_.push_back(other.cos_lat_[index]);
+    }
+
+    size_t CoordinatesBatch::Size() const {
+        return lat_.size();
+    }
+
+    Coordinates CoordinatesBatch::Get(size_t index) const {
+        return { lat_[index], lng_[index] };
+    }
+
+    // ===== Пакетный расчёт =====
+
+    void ComputeDistances(const CoordinatesBatch& from, const CoordinatesBatch& to,
+        double* distances, DistanceFormula formula) {
+        assert(from.Size() == to.Size());
+        ComputeDistancesImpl(
+            { from.lat_.data(), from.lng_.data(), from.sin_lat_.data(), from.cos_lat_.data() },
+            { to.lat_.data(), to.lng_.data(), to.sin_lat_.data(), to.cos_lat_.data() },
+            from.Size(), distances, formula);
+    }
+
+    double ComputePathLength(const CoordinatesBatch& points, DistanceFormula formula) {
+        if (points.Size() < 2) {
+            return 0.0;
+        }
+        const PointsView all{ points.lat_.data(), points.lng_.data(),
+            points.sin_lat_.data(), points.cos_lat_.data() };
+        const size_t segments_count = points.Size() - 1;
+
+        // Отрезки считаются блоками фиксированного размера, сумма накапливается
+        // в порядке следования отрезков
+        double distances[PATH_CHUNK_SIZE];
+        double length = 0.0;
+        for (size_t begin = 0; begin < segments_count; begin += PATH_CHUNK_SIZE) {
+            const size_t count = std::min(PATH_CHUNK_SIZE, segments_count - begin);
+            ComputeDistancesImpl(Shift(all, begin), Shift(all, begin + 1), count, distances, formula);
+            for (size_t i = 0; i < count; ++i) {
+                length += distances[i];
+            }
+        }
+        return length;
+    }
+
+}  // namespace geo
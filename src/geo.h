@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <vector>
+
 namespace geo {
     
     struct Coordinates {
@@ -9,7 +12,46 @@ namespace geo {
         bool operator==(const Coordinates& other) const;
         bool operator!=(const Coordinates& other) const;
     };
+
+    // Формула расчёта расстояния по дуге большого круга
+    enum class DistanceFormula {
+        SPHERICAL_COSINES, // сферическая теорема косинусов, совпадает с ComputeDistance
+        HAVERSINE          // формула гаверсинусов, устойчива на коротких отрезках
+    };
     
     double ComputeDistance(Coordinates from, Coordinates to);
 
-}  // namespace geo
\ No newline at end of file
+    // Набор точек в виде структуры массивов с заранее вычисленными sin/cos широты.
+    // Пакетные функции ниже считают расстояния простыми циклами по этим массивам
+    class CoordinatesBatch {
+    public:
+        void Reserve(size_t count);
+        void Clear();
+        void Add(Coordinates coords);
+        // Копирует уже подготовленную точку другого набора без пересчёта sin/cos
+        void Add(const CoordinatesBatch& other, size_t index);
+
+        size_t Size() const;
+        Coordinates Get(size_t index) const;
+
+    private:
+        std::vector<double> lat_; // [град]
+        std::vector<double> lng_; // [град]
+        std::vector<double> sin_lat_;
+        std::vector<double> cos_lat_;
+
+        friend void ComputeDistances(const CoordinatesBatch& from, const CoordinatesBatch& to,
+            double* distances, DistanceFormula formula);
+        friend double ComputePathLength(const CoordinatesBatch& points, DistanceFormula formula);
+    };
+
+    // Записывает в distances[i] расстояние между from[i] и to[i].
+    // Размер from и to должен совпадать
+    void ComputeDistances(const CoordinatesBatch& from, const CoordinatesBatch& to,
+        double* distances, DistanceFormula formula = DistanceFormula::SPHERICAL_COSINES);
+
+    // Длина ломаной, проходящей через точки набора в порядке их следования
+    double ComputePathLength(const CoordinatesBatch& points,
+        DistanceFormula formula = DistanceFormula::SPHERICAL_COSINES);
+
+}  // namespace geo
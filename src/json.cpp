@@ -1,5 +1,15 @@
 #include "json.h"
 
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace json {
 	using namespace std::literals;
 
@@ -99,299 +109,497 @@ namespace json {
 		return !(*this == other);
 	}
 
+	// ===== class NodeBuilder =====
+
+	void NodeBuilder::StartDict() {
+		PushFrame().container.emplace<Dict>();
+	}
+	void NodeBuilder::Key(std::string_view key) {
+		Frame& frame = stack_[depth_ - 1];
+		frame.key = key;
+		if (std::get<Dict>(frame.container).count(frame.key)) {
+			throw ParsingError("Duplicate key '"s + frame.key + "' have been found");
+		}
+	}
+	void NodeBuilder::EndDict() {
+		--depth_;
+		AddNode(Node(std::move(std::get<Dict>(stack_[depth_].container))));
+	}
+	void NodeBuilder::StartArray() {
+		PushFrame().container.emplace<Array>();
+	}
+	void NodeBuilder::EndArray() {
+		--depth_;
+		AddNode(Node(std::move(std::get<Array>(stack_[depth_].container))));
+	}
+	void NodeBuilder::String(std::string_view value) {
+		AddNode(Node(std::string(value)));
+	}
+	void NodeBuilder::Int(int value) {
+		AddNode(Node(value));
+	}
+	void NodeBuilder::Double(double value) {
+		AddNode(Node(value));
+	}
+	void NodeBuilder::Bool(bool value) {
+		AddNode(Node(value));
+	}
+	void NodeBuilder::Null() {
+		AddNode(Node(nullptr));
+	}
+	bool NodeBuilder::IsComplete() const {
+		return depth_ == 0 && root_.has_value();
+	}
+	Node NodeBuilder::Extract() {
+		Node root = std::move(*root_);
+		root_.reset();
+		return root;
+	}
+	NodeBuilder::Frame& NodeBuilder::PushFrame() {
+		// Кадры не удаляются при закрытии контейнера и переиспользуются
+		if (depth_ == stack_.size()) {
+			stack_.emplace_back();
+		}
+		return stack_[depth_++];
+	}
+	void NodeBuilder::AddNode(Node node) {
+		if (depth_ == 0) {
+			root_ = std::move(node);
+			return;
+		}
+		Frame& frame = stack_[depth_ - 1];
+		if (Array* array = std::get_if<Array>(&frame.container)) {
+			array->push_back(std::move(node));
+		}
+		else {
+			std::get<Dict>(frame.container).emplace(std::move(frame.key), std::move(node));
+		}
+	}
+
 	// ===== LOAD and PRINT =====
 
 	namespace {
 
-		// ----- Load -----
+		// ----- Scan -----
 
-		Node LoadNode(std::istream& input);
+		// Поиск первого символа, требующего особой обработки. Данные просматриваются
+		// блоками по 32 (AVX2) или 16 (SSE2) байт, хвост и прочие платформы - побайтово
 
-		Node LoadString(std::istream& input) {
-			std::string str;
-			char c;
-			while (input.get(c)) {
-				if (c == '"') {
-					break;
-				}
-				if (c == '\\') {
-					input.get(c);
-					switch (c) {
-					case 'n': str += '\n'; break;
-					case 'r': str += '\r'; break;
-					case 't': str += '\t'; break;
-					case '"': str += '"'; break;
-					case '\\': str += '\\'; break;
-					default: throw ParsingError("Invalid escape character");
-					}
+#if defined(__AVX2__)
+		template <typename Matcher>
+		const char* FindFirst(const char* pos, const char* end, Matcher matcher) {
+			for (; end - pos >= 32; pos += 32) {
+				const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+				const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(matcher(block)));
+				if (mask != 0) {
+					return pos + __builtin_ctz(mask);
 				}
-				else {
-					str += c;
+			}
+			return pos;
+		}
+#elif defined(__SSE2__)
+		template <typename Matcher>
+		const char* FindFirst(const char* pos, const char* end, Matcher matcher) {
+			for (; end - pos >= 16; pos += 16) {
+				const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+				const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(matcher(block)));
+				if (mask != 0) {
+					return pos + __builtin_ctz(mask);
 				}
 			}
+			return pos;
+		}
+#endif
 
-			if (!input) {
-				throw ParsingError("Unexpected end (string)");
-			}
+#if defined(__AVX2__)
+		__m256i Equals(__m256i block, char c) {
+			return _mm256_cmpeq_epi8(block, _mm256_set1_epi8(c));
+		}
+		__m256i Or(__m256i lhs, __m256i rhs) {
+			return _mm256_or_si256(lhs, rhs);
+		}
+#elif defined(__SSE2__)
+		__m128i Equals(__m128i block, char c) {
+			return _mm_cmpeq_epi8(block, _mm_set1_epi8(c));
+		}
+		__m128i Or(__m128i lhs, __m128i rhs) {
+			return _mm_or_si128(lhs, rhs);
+		}
+#endif
 
-			return Node(std::move(str));
+		bool IsQuoteOrBackslash(char c) {
+			return c == '"' || c == '\\';
 		}
 
-		std::string LoadLiteral(std::istream& input) {
-			std::string s;
-			while (std::isalpha(input.peek())) {
-				s.push_back(static_cast<char>(input.get()));
-			}
-			return s;
+		bool IsPrintEscaped(char c) {
+			return c == '"' || c == '\\' || c == '\n' || c == '\r' || c == '\t';
 		}
 
-		Node LoadBool(std::istream& input) {
-			const auto s = LoadLiteral(input);
-			if (s == "true"sv) {
-				return Node{ true };
-			}
-			else if (s == "false"sv) {
-				return Node{ false };
-			}
-			else {
-				throw ParsingError("Failed to parse '"s + s + "' as bool"s);
+		// Кавычка или обратная косая черта внутри разбираемой строки
+		const char* FindQuoteOrBackslash(const char* pos, const char* end) {
+#if defined(__AVX2__) || defined(__SSE2__)
+			pos = FindFirst(pos, end, [](auto block) {
+				return Or(Equals(block, '"'), Equals(block, '\\'));
+			});
+#endif
+			while (pos != end && !IsQuoteOrBackslash(*pos)) {
+				++pos;
 			}
+			return pos;
 		}
 
-		Node LoadNull(std::istream& input) {
-			if (auto literal = LoadLiteral(input); literal == "null"sv) {
-				return Node{ nullptr };
-			}
-			else {
-				throw ParsingError("Failed to parse '"s + literal + "' as null"s);
+		// Символ, который при выводе строки заменяется escape-последовательностью
+		const char* FindPrintEscaped(const char* pos, const char* end) {
+#if defined(__AVX2__) || defined(__SSE2__)
+			pos = FindFirst(pos, end, [](auto block) {
+				return Or(Or(Equals(block, '"'), Equals(block, '\\')),
+					Or(Equals(block, '\n'), Or(Equals(block, '\r'), Equals(block, '\t'))));
+			});
+#endif
+			while (pos != end && !IsPrintEscaped(*pos)) {
+				++pos;
 			}
+			return pos;
 		}
 
-		Node LoadNumber(std::istream& input) {
-			std::string parsed_num;
+		// ----- Load -----
 
-			// Считывает в parsed_num очередной символ из input
-			auto read_char = [&parsed_num, &input] {
-				parsed_num += static_cast<char>(input.get());
-				if (!input) {
-					throw ParsingError("Failed to read number from stream"s);
-				}
-				};
+		// Разбор документа, целиком находящегося в памяти, с передачей событий обработчику.
+		// Символы читаются сканированием указателя, без обращений к потоку
+		template <typename Handler>
+		class Parser {
+		public:
+			Parser(std::string_view input, Handler& handler)
+				: pos_(input.data())
+				, end_(input.data() + input.size())
+				, handler_(handler) {
+			}
 
-			// Считывает одну или более цифр в parsed_num из input
-			auto read_digits = [&input, read_char] {
-				if (!std::isdigit(input.peek())) {
-					throw ParsingError("A digit is expected"s);
-				}
-				while (std::isdigit(input.peek())) {
-					read_char();
+			void ParseNode() {
+				char c;
+				if (!ReadChar(c)) {
+					throw ParsingError("Unexpected EOF"s);
 				}
-				};
 
-			if (input.peek() == '-') {
-				read_char();
+				switch (c) {
+				case '[': ParseArray(); break;
+				case '{': ParseDict(); break;
+				case '"': handler_.String(ParseString()); break;
+				case 't': [[fallthrough]];
+				case 'f': --pos_; ParseBool(); break;
+				case 'n': --pos_; ParseNull(); break;
+				default:
+					if (IsDigit(c) || c == '-') {
+						--pos_;
+						ParseNumber();
+						break;
+					}
+					throw ParsingError("Unexpected character: "s + c);
+				}
 			}
-			// Парсим целую часть числа
-			if (input.peek() == '0') {
-				read_char();
-				// После 0 в JSON не могут идти другие цифры
+
+		private:
+			const char* pos_;
+			const char* end_;
+			Handler& handler_;
+			std::string unescaped_; // буфер для строк с экранированием
+
+			static bool IsDigit(char c) {
+				return c >= '0' && c <= '9';
 			}
-			else {
-				read_digits();
+
+			static bool IsAlpha(char c) {
+				return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
 			}
 
-			bool is_int = true;
-			// Парсим дробную часть числа
-			if (input.peek() == '.') {
-				read_char();
-				read_digits();
-				is_int = false;
+			static bool IsSpace(char c) {
+				return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
 			}
 
-			// Парсим экспоненциальную часть числа
-			if (int ch = input.peek(); ch == 'e' || ch == 'E') {
-				read_char();
-				if (ch = input.peek(); ch == '+' || ch == '-') {
-					read_char();
+			// Пропускает пробельные символы и читает следующий символ
+			bool ReadChar(char& c) {
+				while (pos_ != end_ && IsSpace(*pos_)) {
+					++pos_;
+				}
+				if (pos_ == end_) {
+					return false;
 				}
-				read_digits();
-				is_int = false;
+				c = *pos_++;
+				return true;
 			}
 
-			try {
-				if (is_int) {
-					// Сначала пробуем преобразовать строку в int
-					try {
-						return std::stoi(parsed_num);
+			bool PeekIs(char c) const {
+				return pos_ != end_ && *pos_ == c;
+			}
+
+			bool PeekIsDigit() const {
+				return pos_ != end_ && IsDigit(*pos_);
+			}
+
+			// Вызывается после открывающей кавычки. Строка без экранирования
+			// возвращается как представление входных данных, иначе — буфера unescaped_
+			std::string_view ParseString() {
+				bool has_escapes = false;
+				const char* begin = pos_;
+				while (true) {
+					// Участок без кавычек и экранирования обрабатывается целиком
+					const char* run_end = FindQuoteOrBackslash(pos_, end_);
+					if (has_escapes) {
+						unescaped_.append(pos_, run_end);
+					}
+					pos_ = run_end;
+
+					if (pos_ == end_) {
+						throw ParsingError("Unexpected end (string)");
 					}
-					catch (...) {
-						// В случае неудачи, например, при переполнении
-						// код ниже попробует преобразовать строку в double
+					if (*pos_ == '"') {
+						++pos_;
+						if (has_escapes) {
+							return unescaped_;
+						}
+						return { begin, static_cast<size_t>(pos_ - 1 - begin) };
+					}
+
+					if (!has_escapes) {
+						has_escapes = true;
+						unescaped_.assign(begin, pos_);
+					}
+					if (++pos_ == end_) {
+						throw ParsingError("Unexpected end (string)");
+					}
+					switch (*pos_++) {
+					case 'n': unescaped_ += '\n'; break;
+					case 'r': unescaped_ += '\r'; break;
+					case 't': unescaped_ += '\t'; break;
+					case '"': unescaped_ += '"'; break;
+					case '\\': unescaped_ += '\\'; break;
+					default: throw ParsingError("Invalid escape character");
 					}
 				}
-				return std::stod(parsed_num);
-			}
-			catch (...) {
-				throw ParsingError("Failed to convert "s + parsed_num + " to number"s);
 			}
-		}
 
-		Node LoadArray(std::istream& input) {
-			Array arr;
+			std::string_view ParseLiteral() {
+				const char* begin = pos_;
+				while (pos_ != end_ && IsAlpha(*pos_)) {
+					++pos_;
+				}
+				return { begin, static_cast<size_t>(pos_ - begin) };
+			}
 
-			for (char c; input >> c && c != ']';) {
-				if (c != ',') {
-					input.putback(c);
+			void ParseBool() {
+				const auto s = ParseLiteral();
+				if (s == "true"sv) {
+					handler_.Bool(true);
+				}
+				else if (s == "false"sv) {
+					handler_.Bool(false);
+				}
+				else {
+					throw ParsingError("Failed to parse '"s + std::string(s) + "' as bool"s);
 				}
-				arr.push_back(LoadNode(input));
 			}
-			if (!input) {
-				throw ParsingError("Array parsing error"s);
+
+			void ParseNull() {
+				if (auto literal = ParseLiteral(); literal == "null"sv) {
+					handler_.Null();
+				}
+				else {
+					throw ParsingError("Failed to parse '"s + std::string(literal) + "' as null"s);
+				}
 			}
-			return Node(std::move(arr));
-		}
 
-		Node LoadDict(std::istream& input) {
-			Dict dict;
+			void ParseNumber() {
+				const char* begin = pos_;
 
-			for (char c; input >> c && c != '}';) {
-				if (c == '"') {
-					std::string key = LoadString(input).AsString();
-					if (input >> c && c == ':') {
-						if (dict.find(key) != dict.end()) {
-							throw ParsingError("Duplicate key '"s + key + "' have been found");
-						}
-						dict.emplace(std::move(key), LoadNode(input));
+				// Считывает одну или более цифр
+				auto read_digits = [this] {
+					if (!PeekIsDigit()) {
+						throw ParsingError("A digit is expected"s);
 					}
-					else {
-						throw ParsingError(": is expected but '"s + c + "' has been found"s);
+					while (PeekIsDigit()) {
+						++pos_;
 					}
+					};
+
+				if (PeekIs('-')) {
+					++pos_;
 				}
-				else if (c != ',') {
-					throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+				// Парсим целую часть числа
+				if (PeekIs('0')) {
+					++pos_;
+					// После 0 в JSON не могут идти другие цифры
 				}
+				else {
+					read_digits();
+				}
+
+				bool is_int = true;
+				// Парсим дробную часть числа
+				if (PeekIs('.')) {
+					++pos_;
+					read_digits();
+					is_int = false;
+				}
+
+				// Парсим экспоненциальную часть числа
+				if (PeekIs('e') || PeekIs('E')) {
+					++pos_;
+					if (PeekIs('+') || PeekIs('-')) {
+						++pos_;
+					}
+					read_digits();
+					is_int = false;
+				}
+
+				if (is_int) {
+					// Сначала пробуем преобразовать строку в int.
+					// В случае неудачи, например, при переполнении
+					// код ниже попробует преобразовать строку в double
+					int value;
+					if (auto [ptr, ec] = std::from_chars(begin, pos_, value); ec == std::errc{} && ptr == pos_) {
+						handler_.Int(value);
+						return;
+					}
+				}
+				double value;
+				if (auto [ptr, ec] = std::from_chars(begin, pos_, value); ec == std::errc{} && ptr == pos_) {
+					handler_.Double(value);
+					return;
+				}
+				throw ParsingError("Failed to convert "s + std::string(begin, pos_) + " to number"s);
 			}
-			if (!input) {
-				throw ParsingError("Dictionary parsing error"s);
-			}
-			return Node(std::move(dict));
-		}
 
-		Node LoadNode(std::istream& input) {
-			char c;
-			if (!(input >> c)) {
-				throw ParsingError("Unexpected EOF"s);
+			void ParseArray() {
+				handler_.StartArray();
+
+				char c = '\0';
+				bool has_char;
+				while ((has_char = ReadChar(c)) && c != ']') {
+					if (c != ',') {
+						--pos_;
+					}
+					ParseNode();
+				}
+				if (!has_char) {
+					throw ParsingError("Array parsing error"s);
+				}
+				handler_.EndArray();
 			}
 
-			switch (c) {
-			case '[': return LoadArray(input);
-			case '{': return LoadDict(input);
-			case '"': return LoadString(input);
-			case 't': [[fallthrough]];
-			case 'f': input.putback(c); return LoadBool(input);
-			case 'n': input.putback(c); return LoadNull(input);
-			default:
-				if (std::isdigit(c) || c == '-') {
-					input.putback(c);
-					return LoadNumber(input);
+			void ParseDict() {
+				handler_.StartDict();
+
+				char c = '\0';
+				bool has_char;
+				while ((has_char = ReadChar(c)) && c != '}') {
+					if (c == '"') {
+						const std::string_view key = ParseString();
+						if (ReadChar(c) && c == ':') {
+							handler_.Key(key);
+							ParseNode();
+						}
+						else {
+							throw ParsingError(": is expected but '"s + c + "' has been found"s);
+						}
+					}
+					else if (c != ',') {
+						throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+					}
+				}
+				if (!has_char) {
+					throw ParsingError("Dictionary parsing error"s);
 				}
-				throw ParsingError("Unexpected character: "s + c);
+				handler_.EndDict();
 			}
-		}
+		};
 
 		// ----- Print -----
 
 		struct PrintContext {
-			std::ostream& out;
+			OutputBuffer& out;
 			int indent_step = 4;
 			int indent = 0;
+			bool compact = false;
 
 			void PrintIndent() const {
-				for (int i = 0; i < indent; ++i) {
-					out.put(' ');
+				if (!compact) {
+					out.WriteIndent(indent);
+				}
+			}
+
+			void PrintLineBreak() const {
+				if (!compact) {
+					out.Put('\n');
 				}
 			}
 
 			PrintContext Indented() const {
-				return { out, indent_step, indent_step + indent };
+				return { out, indent_step, indent_step + indent, compact };
 			}
 		};
 
-		void PrintString(const std::string& value, std::ostream& out) {
-			out.put('"');
-			for (char c : value) {
-				switch (c) {
-				case '\\': out << "\\\\"sv; break;
-				case '\n': out << "\\n"sv; break;
-				case '\r': out << "\\r"sv; break;
-				case '\t': out << "\\t"sv; break;
-				case '"': out << "\\\""sv; break;
-				default: out.put(c);; break;
-				}
-			}
-			out.put('"');
+		void PrintValue(std::nullptr_t, const PrintContext& ctx) {
+			ctx.out.Write("null"sv);
 		}
 
-		template <typename Value>
-		void PrintValue(const Value& value, const PrintContext& ctx) {
-			ctx.out << value;
+		void PrintValue(bool value, const PrintContext& ctx) {
+			ctx.out.Write(value ? "true"sv : "false"sv);
 		}
 
-		template <>
-		void PrintValue<std::nullptr_t>(const std::nullptr_t&, const PrintContext& ctx) {
-			ctx.out << "null"sv;
+		void PrintValue(int value, const PrintContext& ctx) {
+			ctx.out.WriteInt(value);
 		}
 
-		template <>
-		void PrintValue<bool>(const bool& value, const PrintContext& ctx) {
-			ctx.out << (value ? "true"sv : "false"sv);
+		void PrintValue(double value, const PrintContext& ctx) {
+			ctx.out.WriteDouble(value);
 		}
 
-		template <>
-		void PrintValue<std::string>(const std::string& value, const PrintContext& ctx) {
-			PrintString(value, ctx.out);
+		void PrintValue(const std::string& value, const PrintContext& ctx) {
+			ctx.out.WriteString(value);
 		}
 
 		void PrintNode(const Node& node, const PrintContext& ctx);
 
-		template <>
-		void PrintValue<Array>(const Array& nodes, const PrintContext& ctx) {
-			std::ostream& out = ctx.out;
-			out << "[\n"sv;
+		void PrintValue(const Array& nodes, const PrintContext& ctx) {
+			OutputBuffer& out = ctx.out;
+			out.Put('[');
+			ctx.PrintLineBreak();
 			bool is_first = true;
 			auto inner_ctx = ctx.Indented();
 			for (const Node& node : nodes) {
 				if (!is_first) {
-					out << ",\n"sv;
+					out.Put(',');
+					ctx.PrintLineBreak();
 				}
 				is_first = false;
 				inner_ctx.PrintIndent();
 				PrintNode(node, inner_ctx);
 			}
-			out.put('\n');
+			ctx.PrintLineBreak();
 			ctx.PrintIndent();
-			out.put(']');
+			out.Put(']');
 		}
 
-		template <>
-		void PrintValue<Dict>(const Dict& nodes, const PrintContext& ctx) {
-			std::ostream& out = ctx.out;
-			out << "{\n"sv;
+		void PrintValue(const Dict& nodes, const PrintContext& ctx) {
+			OutputBuffer& out = ctx.out;
+			out.Put('{');
+			ctx.PrintLineBreak();
 			bool is_first = true;
 			auto inner_ctx = ctx.Indented();
 			for (const auto& [key, node] : nodes) {
 				if (!is_first) {
-					ctx.out << ",\n"sv;
+					out.Put(',');
+					ctx.PrintLineBreak();
 				}
 				is_first = false;
 				inner_ctx.PrintIndent();
-				PrintString(key, out);
-				out << ": "sv;
+				out.WriteString(key);
+				out.Write(ctx.compact ? ":"sv : ": "sv);
 				PrintNode(node, inner_ctx);
 			}
-			out.put('\n');
+			ctx.PrintLineBreak();
 			ctx.PrintIndent();
-			out.put('}');
+			out.Put('}');
 		}
 
 		void PrintNode(const Node& node, const PrintContext& ctx) {
@@ -404,12 +612,146 @@ namespace json {
 
 	} // namespace
 
+	Document Load(std::string_view input) {
+		NodeBuilder builder;
+		Parser<NodeBuilder>(input, builder).ParseNode();
+		return Document{ builder.Extract() };
+	}
+
+	void Parse(std::string_view input, EventHandler& handler) {
+		Parser<EventHandler>(input, handler).ParseNode();
+	}
+
 	Document Load(std::istream& input) {
-		return Document{ LoadNode(input) };
+		return Load(ReadAll(input));
+	}
+
+	std::string ReadAll(std::istream& input) {
+		std::string buffer;
+		char chunk[1 << 16];
+		while (input.read(chunk, sizeof(chunk)) || input.gcount() > 0) {
+			buffer.append(chunk, static_cast<size_t>(input.gcount()));
+		}
+		return buffer;
+	}
+
+	// ===== class OutputBuffer =====
+
+	OutputBuffer::OutputBuffer(std::ostream& output, NumberFormat number_format, size_t capacity)
+		: output_(output)
+		, number_format_(number_format)
+		, precision_(static_cast<int>(std::clamp<std::streamsize>(output.precision(), 0, MAX_PRECISION)))
+		, capacity_(std::max(capacity, MAX_NUMBER_LENGTH + MAX_PRECISION))
+		, data_(new char[capacity_]) {
+	}
+
+	OutputBuffer::~OutputBuffer() {
+		Flush();
+	}
+
+	void OutputBuffer::Put(char c) {
+		*Reserve(1) = c;
+		++size_;
+	}
+
+	void OutputBuffer::Write(std::string_view text) {
+		if (text.size() > capacity_) {
+			Flush();
+			output_.write(text.data(), static_cast<std::streamsize>(text.size()));
+			flushed_size_ += text.size();
+			return;
+		}
+		std::memcpy(Reserve(text.size()), text.data(), text.size());
+		size_ += text.size();
+	}
+
+	void OutputBuffer::WriteIndent(int indent) {
+		const size_t size = static_cast<size_t>(std::max(indent, 0));
+		std::memset(Reserve(size), ' ', size);
+		size_ += size;
+	}
+
+	void OutputBuffer::WriteInt(int value) {
+		char* begin = Reserve(MAX_NUMBER_LENGTH);
+		const std::to_chars_result result = std::to_chars(begin, begin + MAX_NUMBER_LENGTH, value);
+		if (result.ec != std::errc{}) {
+			throw std::logic_error("Failed to format an integer"s);
+		}
+		size_ = result.ptr - data_.get();
+	}
+
+	void OutputBuffer::WriteDouble(double value) {
+		// Помимо значащих цифр нужно место под знак, ведущие нули и порядок
+		const size_t max_length = MAX_NUMBER_LENGTH + static_cast<size_t>(precision_);
+		char* begin = Reserve(max_length);
+		char* end = begin + max_length;
+		const std::to_chars_result result = number_format_ == NumberFormat::SHORTEST
+			? std::to_chars(begin, end, value)
+			: std::to_chars(begin, end, value, std::chars_format::general, precision_);
+		if (result.ec != std::errc{}) {
+			throw std::logic_error("Failed to format a number"s);
+		}
+		size_ = result.ptr - data_.get();
+	}
+
+	void OutputBuffer::WriteString(std::string_view value) {
+		Put('"');
+		const char* pos = value.data();
+		const char* end = pos + value.size();
+		while (true) {
+			// Участок без спецсимволов копируется целиком
+			const char* run_end = FindPrintEscaped(pos, end);
+			Write({ pos, static_cast<size_t>(run_end - pos) });
+			if (run_end == end) {
+				break;
+			}
+			switch (*run_end) {
+			case '\\': Write("\\\\"sv); break;
+			case '\n': Write("\\n"sv); break;
+			case '\r': Write("\\r"sv); break;
+			case '\t': Write("\\t"sv); break;
+			case '"': Write("\\\""sv); break;
+			}
+			pos = run_end + 1;
+		}
+		Put('"');
+	}
+
+	void OutputBuffer::Flush() {
+		if (size_ > 0) {
+			output_.write(data_.get(), static_cast<std::streamsize>(size_));
+			flushed_size_ += size_;
+			size_ = 0;
+		}
+	}
+
+	size_t OutputBuffer::GetWrittenSize() const {
+		return flushed_size_ + size_;
+	}
+
+	NumberFormat OutputBuffer::GetNumberFormat() const {
+		return number_format_;
+	}
+
+	int OutputBuffer::GetPrecision() const {
+		return precision_;
+	}
+
+	// Возвращает место под size символов, при необходимости сбрасывая буфер
+	char* OutputBuffer::Reserve(size_t size) {
+		if (capacity_ - size_ < size) {
+			Flush();
+		}
+		return data_.get() + size_;
+	}
+
+	void Print(const Document& doc, std::ostream& output, NumberFormat number_format, Layout layout) {
+		OutputBuffer buffer(output, number_format);
+		PrintNode(doc.GetRoot(), buffer, 0, layout);
 	}
 
-	void Print(const Document& doc, std::ostream& output) {
-		PrintNode(doc.GetRoot(), PrintContext{ output });
+	void PrintNode(const Node& node, OutputBuffer& output, int indent, Layout layout) {
+		PrintNode(node, PrintContext{ output, 4, indent, layout == Layout::COMPACT });
 	}
 
 }  // namespace json
\ No newline at end of file
@@ -2,7 +2,11 @@
 
 #include <iostream>
 #include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -65,9 +69,130 @@ namespace json {
 		Node root_;
 	};
 
+	// Обработчик событий потокового разбора.
+	// Строки и ключи передаются представлениями, действительными только на время вызова
+	class EventHandler {
+	public:
+		virtual ~EventHandler() = default;
+
+		virtual void StartDict() = 0;
+		virtual void Key(std::string_view key) = 0;
+		virtual void EndDict() = 0;
+		virtual void StartArray() = 0;
+		virtual void EndArray() = 0;
+		virtual void String(std::string_view value) = 0;
+		virtual void Int(int value) = 0;
+		virtual void Double(double value) = 0;
+		virtual void Bool(bool value) = 0;
+		virtual void Null() = 0;
+	};
+
+	// Собирает Node из событий разбора
+	class NodeBuilder final : public EventHandler {
+	public:
+		void StartDict() override;
+		void Key(std::string_view key) override;
+		void EndDict() override;
+		void StartArray() override;
+		void EndArray() override;
+		void String(std::string_view value) override;
+		void Int(int value) override;
+		void Double(double value) override;
+		void Bool(bool value) override;
+		void Null() override;
+
+		// Возвращает true, когда получено значение верхнего уровня целиком
+		bool IsComplete() const;
+		Node Extract();
+
+	private:
+		struct Frame {
+			std::variant<Array, Dict> container;
+			std::string key;
+		};
+
+		std::vector<Frame> stack_;
+		size_t depth_ = 0;
+		std::optional<Node> root_;
+
+		Frame& PushFrame();
+		void AddNode(Node node);
+	};
+
+	// Разбирает документ, целиком находящийся в памяти, передавая события обработчику
+	void Parse(std::string_view input, EventHandler& handler);
+
+	// Разбирает документ, целиком находящийся в памяти
+	Document Load(std::string_view input);
+	// Считывает поток до конца и разбирает его содержимое
 	Document Load(std::istream& input);
 
-	void Print(const Document& doc, std::ostream& output);
+	// Считывает поток до конца в строку
+	std::string ReadAll(std::istream& input);
+
+	// Формат вывода чисел с плавающей точкой
+	enum class NumberFormat {
+		// Как operator<< с флагами по умолчанию: %g с точностью precision() потока
+		STREAM_PRECISION,
+		// Кратчайшая запись, которая читается обратно в то же значение
+		SHORTEST
+	};
+
+	// Оформление вывода
+	enum class Layout {
+		// Каждый элемент контейнера на отдельной строке с отступом 4 пробела
+		INDENTED,
+		// Без пробелов и переводов строк: документ занимает одну строку
+		COMPACT
+	};
+
+	// Буфер вывода: накапливает текст и сбрасывает его в поток крупными блоками.
+	// Числа форматируются через std::to_chars и не зависят от локали потока
+	class OutputBuffer {
+	public:
+		static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+
+		// Небольшая ёмкость подходит для коротких документов, которые собираются во временную строку
+		explicit OutputBuffer(std::ostream& output,
+			NumberFormat number_format = NumberFormat::STREAM_PRECISION, size_t capacity = DEFAULT_CAPACITY);
+		OutputBuffer(const OutputBuffer&) = delete;
+		OutputBuffer& operator=(const OutputBuffer&) = delete;
+		~OutputBuffer();
+
+		void Put(char c);
+		void Write(std::string_view text);
+		void WriteIndent(int indent);
+		void WriteInt(int value);
+		void WriteDouble(double value);
+		// Строка в кавычках с экранированием спецсимволов
+		void WriteString(std::string_view value);
+		void Flush();
+		// Общее число символов, выведенных через буфер
+		size_t GetWrittenSize() const;
+		NumberFormat GetNumberFormat() const;
+		int GetPrecision() const;
+
+	private:
+		static constexpr size_t MAX_NUMBER_LENGTH = 64;
+		// Точное десятичное представление double содержит не больше 767 значащих цифр,
+		// поэтому большая точность потока не меняет вывод в формате general
+		static constexpr int MAX_PRECISION = 767;
+
+		char* Reserve(size_t size);
+
+		std::ostream& output_;
+		NumberFormat number_format_;
+		int precision_;
+		size_t capacity_;
+		std::unique_ptr<char[]> data_;
+		size_t size_ = 0;
+		size_t flushed_size_ = 0;
+	};
+
+	void Print(const Document& doc, std::ostream& output,
+		NumberFormat number_format = NumberFormat::STREAM_PRECISION, Layout layout = Layout::INDENTED);
+	// Выводит узел так же, как Print, считая, что текущая строка начата с отступом indent
+	void PrintNode(const Node& node, OutputBuffer& output, int indent = 0, Layout layout = Layout::INDENTED);
 
 	template <typename T>
 	Node::Node(T value) : value_(std::move(value)) {
@@ -0,0 +1,325 @@
+#include "json_arena.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+namespace json::arena {
+	using namespace std::literals;
+
+	// ===== class Arena =====
+
+	Arena::Arena(size_t block_size)
+		: block_size_(block_size) {
+	}
+
+	void* Arena::Allocate(size_t size, size_t alignment) {
+		const size_t padding = (alignment - reinterpret_cast<uintptr_t>(pos_) % alignment) % alignment;
+		if (padding + size > available_) {
+			// Крупные запросы получают отдельный блок
+			const size_t block_size = std::max(block_size_, size + alignment);
+			blocks_.push_back(std::make_unique<char[]>(block_size));
+			pos_ = blocks_.back().get();
+			available_ = block_size;
+			return Allocate(size, alignment);
+		}
+		char* result = pos_ + padding;
+		pos_ = result + size;
+		available_ -= padding + size;
+		return result;
+	}
+
+	std::string_view Arena::CopyString(std::string_view str) {
+		if (str.empty()) {
+			return {};
+		}
+		char* data = AllocateArray<char>(str.size());
+		std::memcpy(data, str.data(), str.size());
+		return { data, str.size() };
+	}
+
+	// ===== class Array =====
+
+	Array::Array(const Value* items, size_t size)
+		: items_(items)
+		, size_(size) {
+	}
+	const Value* Array::begin() const {
+		return items_;
+	}
+	const Value* Array::end() const {
+		return items_ + size_;
+	}
+	size_t Array::size() const {
+		return size_;
+	}
+	bool Array::empty() const {
+		return size_ == 0;
+	}
+	const Value& Array::operator[](size_t index) const {
+		return items_[index];
+	}
+
+	// ===== class Object =====
+
+	Object::Object(const Member* members, size_t size)
+		: members_(members)
+		, size_(size) {
+	}
+	const Member* Object::begin() const {
+		return members_;
+	}
+	const Member* Object::end() const {
+		return members_ + size_;
+	}
+	size_t Object::size() const {
+		return size_;
+	}
+	bool Object::empty() const {
+		return size_ == 0;
+	}
+
+	const Value* Object::Find(std::string_view key) const {
+		if (size_ <= LINEAR_SEARCH_MAX_SIZE) {
+			for (const Member& member : *this) {
+				if (member.key == key) {
+					return &member.value;
+				}
+			}
+			return nullptr;
+		}
+		const Member* it = std::lower_bound(begin(), end(), key, [](const Member& member, std::string_view key) {
+			return member.key < key;
+			});
+		if (it == end() || it->key != key) {
+			return nullptr;
+		}
+		return &it->value;
+	}
+
+	const Value& Object::at(std::string_view key) const {
+		if (const Value* value = Find(key)) {
+			return *value;
+		}
+		throw std::out_of_range("Key '"s + std::string(key) + "' not found"s);
+	}
+
+	size_t Object::count(std::string_view key) const {
+		return Find(key) ? 1 : 0;
+	}
+
+	// ===== class Value =====
+
+	Value::Value()
+		: range_{ nullptr, 0 } {
+	}
+	Value::Value(bool value)
+		: type_(Type::BOOL)
+		, bool_(value) {
+	}
+	Value::Value(int value)
+		: type_(Type::INT)
+		, int_(value) {
+	}
+	Value::Value(double value)
+		: type_(Type::DOUBLE)
+		, double_(value) {
+	}
+	Value::Value(std::string_view value)
+		: type_(Type::STRING)
+		, range_{ value.data(), value.size() } {
+	}
+	Value::Value(Array value)
+		: type_(Type::ARRAY)
+		, range_{ value.begin(), value.size() } {
+	}
+	Value::Value(Object value)
+		: type_(Type::OBJECT)
+		, range_{ value.begin(), value.size() } {
+	}
+
+	Value::Type Value::GetType() const {
+		return type_;
+	}
+
+	bool Value::IsInt() const {
+		return type_ == Type::INT;
+	}
+	bool Value::IsDouble() const {
+		return type_ == Type::DOUBLE || type_ == Type::INT;
+	}
+	bool Value::IsPureDouble() const {
+		return type_ == Type::DOUBLE;
+	}
+	bool Value::IsBool() const {
+		return type_ == Type::BOOL;
+	}
+	bool Value::IsString() const {
+		return type_ == Type::STRING;
+	}
+	bool Value::IsNull() const {
+		return type_ == Type::NULL_VALUE;
+	}
+	bool Value::IsArray() const {
+		return type_ == Type::ARRAY;
+	}
+	bool Value::IsMap() const {
+		return type_ == Type::OBJECT;
+	}
+
+	int Value::AsInt() const {
+		if (IsInt()) {
+			return int_;
+		}
+		throw std::logic_error("Not an int"s);
+	}
+	bool Value::AsBool() const {
+		if (IsBool()) {
+			return bool_;
+		}
+		throw std::logic_error("Not a bool"s);
+	}
+	double Value::AsDouble() const {
+		if (IsPureDouble()) {
+			return double_;
+		}
+		if (IsInt()) {
+			return static_cast<double>(int_);
+		}
+		throw std::logic_error("Not a double"s);
+	}
+	std::string_view Value::AsString() const {
+		if (IsString()) {
+			return { static_cast<const char*>(range_.data), range_.size };
+		}
+		throw std::logic_error("Not a string"s);
+	}
+	Array Value::AsArray() const {
+		if (IsArray()) {
+			return { static_cast<const Value*>(range_.data), range_.size };
+		}
+		throw std::logic_error("Not an array"s);
+	}
+	Object Value::AsMap() const {
+		if (IsMap()) {
+			return { static_cast<const Member*>(range_.data), range_.size };
+		}
+		throw std::logic_error("Not a map"s);
+	}
+
+	// ===== class Document =====
+
+	Document::Document()
+		: arena_(std::make_unique<Arena>()) {
+	}
+
+	Document::Document(std::unique_ptr<Arena> arena, Value root)
+		: arena_(std::move(arena))
+		, root_(root) {
+	}
+
+	const Value& Document::GetRoot() const {
+		return root_;
+	}
+
+	// ===== class DocumentBuilder =====
+
+	DocumentBuilder::DocumentBuilder(std::string_view input)
+		: input_(input)
+		, arena_(std::make_unique<Arena>()) {
+	}
+
+	void DocumentBuilder::StartDict() {
+		stack_.push_back({ true, members_.size(), {} });
+	}
+
+	void DocumentBuilder::Key(std::string_view key) {
+		stack_.back().key = StoreString(key);
+	}
+
+	void DocumentBuilder::EndDict() {
+		const size_t begin = stack_.back().begin;
+		stack_.pop_back();
+
+		auto first = members_.begin() + begin;
+		std::stable_sort(first, members_.end(), [](const Member& lhs, const Member& rhs) {
+			return lhs.key < rhs.key;
+			});
+		auto duplicate = std::adjacent_find(first, members_.end(), [](const Member& lhs, const Member& rhs) {
+			return lhs.key == rhs.key;
+			});
+		if (duplicate != members_.end()) {
+			throw ParsingError("Duplicate key '"s + std::string(duplicate->key) + "' have been found");
+		}
+
+		const size_t size = members_.size() - begin;
+		Member* members = arena_->AllocateArray<Member>(size);
+		std::uninitialized_copy(first, members_.end(), members);
+		members_.resize(begin);
+		AddValue(Value(Object(members, size)));
+	}
+
+	void DocumentBuilder::StartArray() {
+		stack_.push_back({ false, values_.size(), {} });
+	}
+
+	void DocumentBuilder::EndArray() {
+		const size_t begin = stack_.back().begin;
+		stack_.pop_back();
+
+		const size_t size = values_.size() - begin;
+		Value* items = arena_->AllocateArray<Value>(size);
+		std::uninitialized_copy(values_.begin() + begin, values_.end(), items);
+		values_.resize(begin);
+		AddValue(Value(Array(items, size)));
+	}
+
+	void DocumentBuilder::String(std::string_view value) {
+		AddValue(Value(StoreString(value)));
+	}
+	void DocumentBuilder::Int(int value) {
+		AddValue(Value(value));
+	}
+	void DocumentBuilder::Double(double value) {
+		AddValue(Value(value));
+	}
+	void DocumentBuilder::Bool(bool value) {
+		AddValue(Value(value));
+	}
+	void DocumentBuilder::Null() {
+		AddValue(Value());
+	}
+
+	Document DocumentBuilder::Extract() {
+		return Document(std::move(arena_), root_);
+	}
+
+	std::string_view DocumentBuilder::StoreString(std::string_view str) {
+		// Строка без экранирования уже лежит во входных данных
+		const std::less_equal<const char*> less_equal;
+		if (less_equal(input_.data(), str.data()) && less_equal(str.data() + str.size(), input_.data() + input_.size())) {
+			return str;
+		}
+		return arena_->CopyString(str);
+	}
+
+	void DocumentBuilder::AddValue(Value value) {
+		if (stack_.empty()) {
+			root_ = value;
+		}
+		else if (stack_.back().is_object) {
+			members_.push_back({ stack_.back().key, value });
+		}
+		else {
+			values_.push_back(value);
+		}
+	}
+
+	Document Load(std::string_view input) {
+		DocumentBuilder builder(input);
+		Parse(input, builder);
+		return builder.Extract();
+	}
+
+} // namespace json::arena
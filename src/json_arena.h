@@ -0,0 +1,185 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "json.h"
+
+// Альтернативное представление JSON-документа для чтения.
+// Все узлы размещаются в монотонной арене и освобождаются вместе с документом,
+// объекты хранятся плоскими массивами пар ключ-значение, отсортированными по ключу,
+// а строки без экранирования ссылаются прямо на входные данные
+namespace json::arena {
+
+	// Монотонный распределитель памяти: выделяет память блоками
+	// и освобождает её только целиком при разрушении
+	class Arena {
+	public:
+		explicit Arena(size_t block_size = 64 * 1024);
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+
+		void* Allocate(size_t size, size_t alignment);
+		std::string_view CopyString(std::string_view str);
+
+		template <typename T>
+		T* AllocateArray(size_t count) {
+			return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+		}
+
+	private:
+		size_t block_size_;
+		std::vector<std::unique_ptr<char[]>> blocks_;
+		char* pos_ = nullptr;
+		size_t available_ = 0;
+	};
+
+	class Value;
+	struct Member;
+
+	class Array {
+	public:
+		Array() = default;
+		Array(const Value* items, size_t size);
+
+		const Value* begin() const;
+		const Value* end() const;
+		size_t size() const;
+		bool empty() const;
+		const Value& operator[](size_t index) const;
+
+	private:
+		const Value* items_ = nullptr;
+		size_t size_ = 0;
+	};
+
+	class Object {
+	public:
+		Object() = default;
+		Object(const Member* members, size_t size);
+
+		const Member* begin() const;
+		const Member* end() const;
+		size_t size() const;
+		bool empty() const;
+
+		// Возвращает nullptr, если ключ не найден
+		const Value* Find(std::string_view key) const;
+		// Бросает std::out_of_range, если ключ не найден
+		const Value& at(std::string_view key) const;
+		size_t count(std::string_view key) const;
+
+	private:
+		// Для небольших объектов линейный просмотр быстрее двоичного поиска
+		static constexpr size_t LINEAR_SEARCH_MAX_SIZE = 8;
+
+		const Member* members_ = nullptr;
+		size_t size_ = 0;
+	};
+
+	class Value {
+	public:
+		enum class Type : uint8_t { NULL_VALUE, BOOL, INT, DOUBLE, STRING, ARRAY, OBJECT };
+
+		Value();
+		explicit Value(bool value);
+		explicit Value(int value);
+		explicit Value(double value);
+		explicit Value(std::string_view value);
+		explicit Value(Array value);
+		explicit Value(Object value);
+
+		Type GetType() const;
+
+		bool IsInt() const;
+		bool IsDouble() const;
+		bool IsPureDouble() const;
+		bool IsBool() const;
+		bool IsString() const;
+		bool IsNull() const;
+		bool IsArray() const;
+		bool IsMap() const;
+
+		int AsInt() const;
+		bool AsBool() const;
+		double AsDouble() const;
+		std::string_view AsString() const;
+		Array AsArray() const;
+		Object AsMap() const;
+
+	private:
+		struct Range {
+			const void* data;
+			size_t size;
+		};
+
+		Type type_ = Type::NULL_VALUE;
+		union {
+			bool bool_;
+			int int_;
+			double double_;
+			Range range_;
+		};
+	};
+
+	struct Member {
+		std::string_view key;
+		Value value;
+	};
+
+	class Document {
+	public:
+		Document();
+		Document(std::unique_ptr<Arena> arena, Value root);
+
+		const Value& GetRoot() const;
+
+	private:
+		std::unique_ptr<Arena> arena_;
+		Value root_;
+	};
+
+	// Собирает документ в арене из событий разбора. Строки, которые ссылаются
+	// на input, не копируются, поэтому input должен жить дольше документа
+	class DocumentBuilder final : public EventHandler {
+	public:
+		explicit DocumentBuilder(std::string_view input);
+
+		void StartDict() override;
+		void Key(std::string_view key) override;
+		void EndDict() override;
+		void StartArray() override;
+		void EndArray() override;
+		void String(std::string_view value) override;
+		void Int(int value) override;
+		void Double(double value) override;
+		void Bool(bool value) override;
+		void Null() override;
+
+		Document Extract();
+
+	private:
+		struct Frame {
+			bool is_object;
+			size_t begin; // начало элементов контейнера в values_ или members_
+			std::string_view key; // ключ, ожидающий значения
+		};
+
+		std::string_view input_;
+		std::unique_ptr<Arena> arena_;
+		std::vector<Frame> stack_;
+		std::vector<Value> values_;
+		std::vector<Member> members_;
+		Value root_;
+
+		std::string_view StoreString(std::string_view str);
+		void AddValue(Value value);
+	};
+
+	// Разбирает документ; input должен жить дольше результата
+	Document Load(std::string_view input);
+
+} // namespace json::arena
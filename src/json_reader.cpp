@@ -1,17 +1,26 @@
 #include "json_reader.h"
 
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 #include <sstream>
+#include <unordered_map>
 
-#include "json_builder.h"
+#include "mapped_file.h"
+#include "profiler.h"
+#include "trace.h"
+#include "thread_pool.h"
 
 namespace detail {
-	svg::Color ParseColor(const json::Node& color_node) {
+	svg::Color ParseColor(const json::arena::Value& color_node) {
 		if (color_node.IsString()) {
-			return color_node.AsString();
+			return std::string(color_node.AsString());
 		}
 		else if (color_node.IsArray()) {
-			const auto& color_array = color_node.AsArray();
+			const auto color_array = color_node.AsArray();
 			if (color_array.size() == 3) {
 				return svg::Rgb{
 					static_cast<uint8_t>(color_array[0].AsInt()),
@@ -31,7 +40,7 @@ namespace detail {
 		return svg::NoneColor;
 	}
 
-	std::vector<svg::Color> ReadColorPalette(const json::Array& color_array) {
+	std::vector<svg::Color> ReadColorPalette(const json::arena::Array& color_array) {
 		std::vector<svg::Color> color_palette;
 		color_palette.reserve(color_array.size());
 		for (const auto& color : color_array) {
@@ -40,197 +49,938 @@ namespace detail {
 		return color_palette;
 	}
 
-	svg::Point ReadLabelOffset(const json::Array& label_offset) {
+	svg::Point ReadLabelOffset(const json::arena::Array& label_offset) {
 		return {
 			label_offset[0].AsDouble(), // dx
 			label_offset[1].AsDouble() // dy
 		};
 	}
+
+	std::ostream& SetPrecision(std::ostream& stream, std::streamsize precision) {
+		stream.precision(precision);
+		return stream;
+	}
+
+	// Тип запроса и его параметры: у запросов с одинаковым ключом ответы различаются только request_id.
+	// Для запросов неизвестного типа возвращает nullopt
+	std::optional<std::string> MakeRequestKey(const json::arena::Object& request_map) {
+		const std::string_view type = request_map.at("type").AsString();
+
+		std::string key(type);
+		if (type == "Bus" || type == "Stop") {
+			key += '\0';
+			key += request_map.at("name").AsString();
+		}
+		else if (type == "Route") {
+			key += '\0';
+			key += request_map.at("from").AsString();
+			key += '\0';
+			key += request_map.at("to").AsString();
+		}
+		else if (type != "Map") {
+			return std::nullopt;
+		}
+		return key;
+	}
+
+	// Ключ кеша ответов: ключ запроса и оформление вывода.
+	// Карта кешируется отдельно, поэтому для запросов Map возвращает nullopt
+	std::optional<std::string> MakeResponseCacheKey(const json::arena::Object& request_map,
+		const json::OutputBuffer& output, json::Layout layout, int indent) {
+		if (request_map.at("type").AsString() == "Map") {
+			return std::nullopt;
+		}
+		std::optional<std::string> key = MakeRequestKey(request_map);
+		if (!key) {
+			return std::nullopt;
+		}
+		*key += '\0';
+		*key += std::to_string(static_cast<int>(layout)) + ' ' + std::to_string(indent) + ' '
+			+ std::to_string(static_cast<int>(output.GetNumberFormat())) + ' ' + std::to_string(output.GetPrecision());
+		return key;
+	}
 } // namespace detail
 
 
 namespace transport_catalogue {
 	using namespace std::literals;
 
-	JsonReader::JsonReader(TransportCatalogue& catalogue) :
-		catalogue_(catalogue) {
-	}
+	namespace {
 
-	void JsonReader::ProcessBaseRequests(const json::Document& doc) {
-		const json::Array& base_requests = doc.GetRoot()
-			.AsMap().at("base_requests").AsArray();
+		// Запрос из base_requests, собранный из событий разбора
+		// Строки ссылаются на входные данные или на копии в InputHandler
+		struct BaseRequest {
+			std::string_view type;
+			std::string_view name;
+			geo::Coordinates position{ 0.0, 0.0 };
+			std::vector<std::pair<std::string_view, unsigned int>> road_distances;
+			std::vector<std::string_view> stops;
+			bool is_roundtrip = false;
+			// Поля, встреченные со значением подходящего типа
+			bool has_type = false;
+			bool has_name = false;
+			bool has_latitude = false;
+			bool has_longitude = false;
+			bool has_stops = false;
+			bool has_is_roundtrip = false;
+			// road_distances необязательно, но должно быть словарём целых чисел
+			bool has_valid_road_distances = true;
+		};
 
-		// 1. Add Stops
-		for (const auto& request : base_requests) {
-			const auto& request_map = request.AsMap();
+		enum class ValueType {
+			STRING,
+			INT,
+			DOUBLE,
+			BOOL,
+			NULL_VALUE,
+			DICT,
+			ARRAY
+		};
 
-			if (request_map.at("type").AsString() == "Stop") {
-				std::string stop_name = request_map.at("name").AsString();
+		struct PendingDistance {
+			std::string_view from;
+			std::string_view to;
+			unsigned int distance;
+		};
 
-				catalogue_.AddStop({ stop_name,
-					{request_map.at("latitude").AsDouble(),
-					request_map.at("longitude").AsDouble()} });
+		// Передаёт остановки, расстояния и маршруты из base_requests в справочник по мере разбора,
+		// не строя дерево документа. Расстояния и маршруты со ссылками на ещё не встреченные
+		// остановки откладываются до конца раздела. Маршруты добавляются в порядке следования.
+		// Запрос без обязательного поля или с полем неверного типа отвергается исключением.
+		// Остальные разделы документа собираются в json::arena::Document
+		class InputHandler final : public json::EventHandler {
+		public:
+			InputHandler(TransportCatalogue& catalogue, std::string_view input)
+				: catalogue_(catalogue)
+				, input_(input)
+				, sections_(input) {
+			}
+
+			void StartDict() override {
+				CheckValue(ValueType::DICT);
+				++depth_;
+				if (!in_base_requests_) {
+					sections_.StartDict();
+				}
+				else if (depth_ == REQUEST_DEPTH) {
+					request_ = {};
+				}
 			}
-		}
-		// 2. Add Distances
-		for (const auto& request : base_requests) {
-			const auto& request_map = request.AsMap();
 
-			if (request_map.at("type").AsString() == "Stop") {
-				std::string stop_name = request_map.at("name").AsString();
+			void Key(std::string_view key) override {
+				if (!in_base_requests_) {
+					if (depth_ == 1 && key == "base_requests"sv) {
+						in_base_requests_ = true;
+					}
+					else {
+						sections_.Key(key);
+					}
+				}
+				else if (depth_ == REQUEST_DEPTH) {
+					field_ = key;
+				}
+				else if (depth_ == REQUEST_DEPTH + 1) {
+					road_distance_to_ = Keep(key);
+				}
+			}
 
-				if (request_map.count("road_distances")) {
-					for (const auto& [stop_name_to, distance] :
-						request_map.at("road_distances").AsMap())
-						catalogue_.AddDistanceBetweenStops(
-							stop_name,
-							stop_name_to,
-							distance.AsInt()
-						);
+			void EndDict() override {
+				if (!in_base_requests_) {
+					sections_.EndDict();
+				}
+				else if (depth_ == REQUEST_DEPTH) {
+					ProcessRequest();
 				}
+				CloseContainer();
 			}
-		}
-		// 3. Add Buses
-		for (const auto& request : base_requests) {
-			const auto& request_map = request.AsMap();
 
-			if (request_map.at("type").AsString() == "Bus") {
-				std::string bus_name = request_map.at("name").AsString();
-				const auto& stop_names = request_map.at("stops").AsArray();
-				bool is_roundtrip = request_map.at("is_roundtrip").AsBool();
+			void StartArray() override {
+				CheckValue(ValueType::ARRAY);
+				++depth_;
+				if (!in_base_requests_) {
+					sections_.StartArray();
+				}
+			}
 
-				std::vector<const Stop*> bus_stops;
-				if (is_roundtrip) {
-					bus_stops.reserve(stop_names.size());
+			void EndArray() override {
+				if (!in_base_requests_) {
+					sections_.EndArray();
+				}
+				CloseContainer();
+			}
+
+			void String(std::string_view value) override {
+				CheckValue(ValueType::STRING);
+				if (!in_base_requests_) {
+					sections_.String(value);
+				}
+				else if (depth_ == REQUEST_DEPTH && field_ == "type"sv) {
+					request_.type = Keep(value);
+				}
+				else if (depth_ == REQUEST_DEPTH && field_ == "name"sv) {
+					request_.name = Keep(value);
+				}
+				else if (depth_ == REQUEST_DEPTH + 1 && field_ == "stops"sv) {
+					request_.stops.push_back(Keep(value));
+				}
+			}
+
+			void Int(int value) override {
+				CheckValue(ValueType::INT);
+				if (!in_base_requests_) {
+					sections_.Int(value);
+				}
+				else if (depth_ == REQUEST_DEPTH + 1 && field_ == "road_distances"sv) {
+					request_.road_distances.emplace_back(road_distance_to_, static_cast<unsigned int>(value));
+				}
+				else {
+					SetCoordinate(value);
+				}
+			}
+
+			void Double(double value) override {
+				CheckValue(ValueType::DOUBLE);
+				if (!in_base_requests_) {
+					sections_.Double(value);
 				}
 				else {
-					bus_stops.reserve(stop_names.size() * 2 - 1);
+					SetCoordinate(value);
+				}
+			}
+
+			void Bool(bool value) override {
+				CheckValue(ValueType::BOOL);
+				if (!in_base_requests_) {
+					sections_.Bool(value);
+				}
+				else if (depth_ == REQUEST_DEPTH && field_ == "is_roundtrip"sv) {
+					request_.is_roundtrip = value;
+				}
+			}
+
+			void Null() override {
+				CheckValue(ValueType::NULL_VALUE);
+				if (!in_base_requests_) {
+					sections_.Null();
 				}
+			}
+
+			// Разделы документа, кроме base_requests
+			json::arena::Document ExtractSections() {
+				return sections_.Extract();
+			}
+
+		private:
+			// Глубина вложенности объекта запроса: корень -> base_requests -> запрос
+			static constexpr size_t REQUEST_DEPTH = 3;
+
+			TransportCatalogue& catalogue_;
+			std::string_view input_;
+			json::arena::DocumentBuilder sections_;
+			size_t depth_ = 0;
+			bool in_base_requests_ = false;
+
+			BaseRequest request_;
+			std::string field_;
+			std::string_view road_distance_to_;
+			std::vector<PendingDistance> pending_distances_;
+			std::vector<BaseRequest> pending_buses_;
+			std::deque<std::string> unescaped_strings_;
 
-				for (const auto& stop_name : stop_names) {
-					bus_stops.push_back(catalogue_.FindStop(stop_name.AsString()));
+			// Строки без экранирования указывают во входные данные и живут дольше разбора.
+			// Остальные находятся во временном буфере парсера и копируются
+			std::string_view Keep(std::string_view value) {
+				const std::less<const char*> less;
+				if (!less(value.data(), input_.data())
+					&& !less(input_.data() + input_.size(), value.data() + value.size())) {
+					return value;
 				}
+				return unescaped_strings_.emplace_back(value);
+			}
 
-				if (!is_roundtrip && !bus_stops.empty()) {
-					bus_stops.insert(bus_stops.end(), bus_stops.rbegin() + 1, bus_stops.rend());
+			void SetCoordinate(double value) {
+				if (depth_ != REQUEST_DEPTH) {
+					return;
+				}
+				if (field_ == "latitude"sv) {
+					request_.position.lat = value;
 				}
+				else if (field_ == "longitude"sv) {
+					request_.position.lng = value;
+				}
+			}
 
-				catalogue_.AddBus({
-					bus_name,
-					std::move(bus_stops),
-					is_roundtrip
+			// Проверяет тип значения внутри base_requests до его обработки.
+			// Ошибки полей запроса проявляются в ProcessRequest, когда известен тип запроса
+			void CheckValue(ValueType type) {
+				if (!in_base_requests_) {
+					return;
+				}
+				if (depth_ == REQUEST_DEPTH - 2 && type != ValueType::ARRAY) {
+					throw std::invalid_argument("base_requests is not an array"s);
+				}
+				if (depth_ == REQUEST_DEPTH - 1 && type != ValueType::DICT) {
+					throw std::invalid_argument("Base request is not a dict"s);
+				}
+				if (depth_ == REQUEST_DEPTH) {
+					if (field_ == "type"sv) {
+						request_.has_type = type == ValueType::STRING;
+					}
+					else if (field_ == "name"sv) {
+						request_.has_name = type == ValueType::STRING;
+					}
+					else if (field_ == "latitude"sv) {
+						request_.has_latitude = type == ValueType::INT || type == ValueType::DOUBLE;
+					}
+					else if (field_ == "longitude"sv) {
+						request_.has_longitude = type == ValueType::INT || type == ValueType::DOUBLE;
+					}
+					else if (field_ == "stops"sv) {
+						request_.has_stops = type == ValueType::ARRAY;
+					}
+					else if (field_ == "is_roundtrip"sv) {
+						request_.has_is_roundtrip = type == ValueType::BOOL;
+					}
+					else if (field_ == "road_distances"sv) {
+						request_.has_valid_road_distances = type == ValueType::DICT;
+					}
+				}
+				else if (depth_ == REQUEST_DEPTH + 1) {
+					if (field_ == "stops"sv && type != ValueType::STRING) {
+						request_.has_stops = false;
+					}
+					else if (field_ == "road_distances"sv && type != ValueType::INT) {
+						request_.has_valid_road_distances = false;
+					}
+				}
+			}
+
+			void RequireField(bool has_field, std::string_view field) const {
+				if (!has_field) {
+					std::string message = "Missing or invalid '"s + std::string(field) + "' in base request"s;
+					if (request_.has_name) {
+						message += " '"s + std::string(request_.name) + "'"s;
+					}
+					throw std::invalid_argument(message);
+				}
+			}
+
+			void CloseContainer() {
+				--depth_;
+				if (in_base_requests_ && depth_ == 1) {
+					in_base_requests_ = false;
+					ProcessPendingRequests();
+				}
+			}
+
+			bool AllStopsKnown(const std::vector<std::string_view>& stop_names) const {
+				return std::all_of(stop_names.begin(), stop_names.end(), [this](std::string_view stop_name) {
+					return catalogue_.FindStop(stop_name) != nullptr;
 					});
 			}
+
+			void AddBus(const BaseRequest& request) {
+				std::vector<const Stop*> bus_stops;
+				bus_stops.reserve(request.stops.size());
+				for (const auto& stop_name : request.stops) {
+					const Stop* stop = catalogue_.FindStop(stop_name);
+					if (!stop) {
+						throw std::out_of_range("Unknown stop '"s + std::string(stop_name)
+							+ "' in bus '"s + std::string(request.name) + "'"s);
+					}
+					bus_stops.push_back(stop);
+				}
+				catalogue_.AddBus({ request.name, std::move(bus_stops), request.is_roundtrip });
+			}
+
+			void ProcessRequest() {
+				RequireField(request_.has_type, "type"sv);
+				if (request_.type == "Stop"sv) {
+					RequireField(request_.has_name, "name"sv);
+					RequireField(request_.has_latitude, "latitude"sv);
+					RequireField(request_.has_longitude, "longitude"sv);
+					RequireField(request_.has_valid_road_distances, "road_distances"sv);
+					catalogue_.AddStop({ request_.name, request_.position });
+					for (const auto& [stop_name_to, distance] : request_.road_distances) {
+						if (catalogue_.FindStop(stop_name_to)) {
+							catalogue_.AddDistanceBetweenStops(request_.name, stop_name_to, distance);
+						}
+						else {
+							pending_distances_.push_back({ request_.name, stop_name_to, distance });
+						}
+					}
+				}
+				else if (request_.type == "Bus"sv) {
+					RequireField(request_.has_name, "name"sv);
+					RequireField(request_.has_stops, "stops"sv);
+					RequireField(request_.has_is_roundtrip, "is_roundtrip"sv);
+					// После первого отложенного маршрута откладываются и все следующие,
+					// чтобы сохранить порядок добавления
+					if (pending_buses_.empty() && AllStopsKnown(request_.stops)) {
+						AddBus(request_);
+					}
+					else {
+						pending_buses_.push_back(std::move(request_));
+					}
+				}
+			}
+
+			void ProcessPendingRequests() {
+				for (const auto& [from, to, distance] : pending_distances_) {
+					catalogue_.AddDistanceBetweenStops(from, to, distance);
+				}
+				for (const auto& request : pending_buses_) {
+					AddBus(request);
+				}
+				pending_distances_.clear();
+				pending_buses_.clear();
+			}
+		};
+
+	} // namespace
+
+	JsonReader::JsonReader(TransportCatalogue& catalogue) :
+		catalogue_(catalogue),
+		response_cache_(std::make_unique<response_cache::ResponseCache>(DEFAULT_CACHE_CAPACITY)) {
+	}
+
+	const transport_router::TransportRouter& JsonReader::GetTransportRouter() const {
+		std::call_once(lazy_objects_->transport_router_flag, [this] {
+			lazy_objects_->transport_router.emplace(catalogue_, ReadRoutingSettings());
+			});
+		return *lazy_objects_->transport_router;
+	}
+
+	void JsonReader::StartTransportRouterBuild() const {
+		LazyObjects& lazy_objects = *lazy_objects_;
+		if (!lazy_objects.transport_router_ready.valid()) {
+			// Ошибка построения не теряется: её получит первый запрос Route, повторив построение
+			lazy_objects.transport_router_ready = std::async(std::launch::async, [this] {
+				GetTransportRouter();
+				}).share();
 		}
 	}
 
-	void JsonReader::InitializeTransportRouter(const json::Document& doc) {
-		const json::Dict& routing_settings = doc.GetRoot()
-			.AsMap().at("routing_settings").AsMap();
+	const transport_router::TransportRouter& JsonReader::WaitTransportRouter(const deadline::Deadline& deadline) const {
+		const auto& ready = lazy_objects_->transport_router_ready;
+		if (ready.valid() && deadline.IsLimited()
+			&& ready.wait_until(*deadline.GetTime()) != std::future_status::ready) {
+			throw deadline::DeadlineExceeded();
+		}
+		// Построение без фонового потока прервать нельзя: роутер нужен и следующим запросам
+		const transport_router::TransportRouter& transport_router = GetTransportRouter();
+		deadline.CheckNow();
+		return transport_router;
+	}
 
-		transport_router_.emplace(catalogue_, transport_router::RoutingSettings{
-			routing_settings.at("bus_wait_time").AsInt(),
-			routing_settings.at("bus_velocity").AsDouble()
+	bool JsonReader::IsTransportRouterReady() const {
+		const auto& ready = lazy_objects_->transport_router_ready;
+		return !ready.valid() || ready.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}
+
+	const map_renderer::MapRenderer& JsonReader::GetMapRenderer() const {
+		std::call_once(lazy_objects_->map_renderer_flag, [this] {
+			lazy_objects_->map_renderer.emplace(ProcessRenderRequest(sections_));
 			});
+		return *lazy_objects_->map_renderer;
+	}
+
+	std::shared_ptr<const std::string> JsonReader::GetMapJson(const deadline::Deadline& deadline) const {
+		LazyObjects& lazy_objects = *lazy_objects_;
+		std::unique_lock lock(lazy_objects.map_mutex, std::defer_lock);
+		if (!deadline.IsLimited()) {
+			lock.lock();
+		}
+		else if (!lock.try_lock_until(*deadline.GetTime())) {
+			throw deadline::DeadlineExceeded();
+		}
+		if (lazy_objects.map_version != catalogue_.GetVersion()) {
+			const profiler::ScopedPhase phase("render_map");
+			request_handler::RequestHandler request_handler(catalogue_, GetMapRenderer());
+			svg::Document map = request_handler.RenderMap();
+			deadline.CheckNow();
+			std::ostringstream svg_output;
+			map.Render(svg_output);
+			deadline.CheckNow();
+
+			std::ostringstream json_output;
+			json::OutputBuffer(json_output).WriteString(svg_output.str());
+			lazy_objects.map_json = std::make_shared<const std::string>(json_output.str());
+			lazy_objects.map_version = catalogue_.GetVersion();
+		}
+		return lazy_objects.map_json;
+	}
+
+	void JsonReader::SetThreadsCount(size_t threads_count) {
+		threads_count_ = threads_count;
 	}
 
-	json::Array JsonReader::ProcessStatRequests(const json::Document& doc) const {
-		const json::Array& stat_requests = doc.GetRoot()
-			.AsMap().at("stat_requests").AsArray();
-		json::Array result;
+	void JsonReader::SetPipeline(bool pipeline) {
+		pipeline_ = pipeline;
+	}
 
-		for (const auto& request : stat_requests) {
-			const auto& request_map = request.AsMap();
+	void JsonReader::SetRequestTimeout(std::chrono::milliseconds timeout) {
+		request_timeout_ = timeout;
+	}
 
-			json::Builder response;
-			auto dict_context = response.StartDict();
+	void JsonReader::SetBatchTimeout(std::chrono::milliseconds timeout) {
+		batch_timeout_ = timeout;
+	}
 
-			dict_context.Key("request_id").Value(request_map.at("id").AsInt());
+	void JsonReader::SetCacheCapacity(size_t capacity) {
+		response_cache_ = std::make_unique<response_cache::ResponseCache>(capacity);
+	}
 
-			// "Map" command
-			if (request_map.at("type").AsString() == "Map") {
+	const response_cache::ResponseCache& JsonReader::GetResponseCache() const {
+		return *response_cache_;
+	}
 
-				map_renderer::MapRenderer renderer(ProcessRenderRequest(doc));
-				request_handler::RequestHandler request_handler(catalogue_, renderer);
-				svg::Document map = request_handler.RenderMap();
-				std::ostringstream svg_output;
-				map.Render(svg_output);
+	void JsonReader::EnableStats() {
+		stats_ = std::make_unique<request_stats::RequestStats>();
+	}
 
-				dict_context.Key("map").Value(svg_output.str());
+	void JsonReader::PrintStats(std::ostream& output) const {
+		// Счётчики могут не поместиться в int, который хранит json::Node
+		const auto count = [](uint64_t value) -> json::Node::Value {
+			if (value <= static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+				return static_cast<int>(value);
 			}
+			return static_cast<double>(value);
+		};
+		const auto microseconds = [](uint64_t nanoseconds) {
+			return static_cast<double>(nanoseconds) / 1000.0;
+		};
+
+		const request_stats::RequestStats stats = stats_ ? *stats_ : request_stats::RequestStats{};
+		json::Writer writer(output, json::NumberFormat::SHORTEST);
+		auto dict_context = writer.StartDict();
+
+		dict_context.Key("cache").StartDict()
+			.Key("hits").Value(count(response_cache_->GetHits()))
+			.Key("misses").Value(count(response_cache_->GetMisses()))
+			.EndDict();
+
+		auto requests_context = dict_context.Key("requests").StartDict();
+		for (size_t i = 0; i < request_stats::REQUEST_TYPES_COUNT; ++i) {
+			const auto type = static_cast<request_stats::RequestType>(i);
+			const request_stats::LatencyHistogram& latency = stats.GetLatency(type);
+			if (latency.GetCount() == 0) {
+				continue;
+			}
+			requests_context.Key(std::string(request_stats::GetRequestTypeName(type))).StartDict()
+				.Key("count").Value(count(latency.GetCount()))
+				.Key("max_us").Value(microseconds(latency.GetMax()))
+				.Key("p50_us").Value(microseconds(latency.GetPercentile(0.5)))
+				.Key("p90_us").Value(microseconds(latency.GetPercentile(0.9)))
+				.Key("p99_us").Value(microseconds(latency.GetPercentile(0.99)))
+				.EndDict();
+		}
+		requests_context.EndDict();
+
+		auto routing_context = dict_context.Key("routing").StartDict();
+		const auto& transport_router = lazy_objects_->transport_router;
+		if (transport_router) {
+			routing_context.Key("edges").Value(count(transport_router->GetEdgeCount()))
+				.Key("precompute_relaxations").Value(count(transport_router->GetRelaxationsCount()));
+		}
+		routing_context.Key("route_edges").Value(count(stats.GetRouteEdges()))
+			.Key("routes_found").Value(count(stats.GetRoutesFound()));
+		if (transport_router) {
+			routing_context.Key("vertices").Value(count(transport_router->GetVertexCount()));
+		}
+		routing_context.EndDict();
 
-			// "Stop" command
-			if (request_map.at("type").AsString() == "Stop") {
-				const Stop* stop = catalogue_.FindStop(request_map.at("name").AsString());
-				if (!stop) {
-					dict_context.Key("error_message").Value("not found"s);
+		dict_context.EndDict();
+		writer.Finish();
+		output << std::endl;
+	}
+
+	void JsonReader::WriteStatResponses(const json::arena::Array& stat_requests, std::ostream& output,
+		json::NumberFormat number_format) const {
+		// Запросы делятся на части, которые потоки пула сериализуют независимо.
+		// Готовые части выводятся по порядку окнами, чтобы не держать в памяти весь ответ
+		constexpr size_t REQUESTS_PER_CHUNK = 256;
+		constexpr size_t CHUNKS_PER_THREAD = 4;
+		constexpr int RESPONSE_INDENT = 4;
+
+		// Границы ответа и значения request_id в нём
+		struct ResponseSpan {
+			size_t begin = 0;
+			size_t end = 0;
+			std::pair<size_t, size_t> request_id;
+			std::optional<size_t> route_edges;
+		};
+
+		struct ResponsesChunk {
+			std::string text;
+			// Ответы в порядке запросов. Отложенные ответы Route дописываются
+			// в конец text, поэтому границы не обязаны возрастать
+			std::vector<ResponseSpan> spans;
+		};
+
+		// Какие запросы части обрабатываются за один проход
+		enum class Pass { ALL, WITHOUT_ROUTES, ONLY_ROUTES };
+
+		// Собственный буфер сериализации каждого потока
+		struct WorkerScratch {
+			std::ostringstream stream;
+			json::OutputBuffer buffer;
+			request_stats::RequestStats stats;
+
+			WorkerScratch(std::streamsize precision, json::NumberFormat number_format)
+				: buffer(detail::SetPrecision(stream, precision), number_format) {
+			}
+		};
+
+		// Одинаковые запросы вычисляются один раз: ответ первого из них выводится
+		// для остальных с подстановкой их request_id.
+		// Заодно до начала вывода проверяются поля запросов и нужные им настройки,
+		// чтобы ошибка во входных данных не оставила в выводе незаконченный массив
+		std::vector<size_t> first_duplicates(stat_requests.size());
+		std::vector<size_t> duplicates_left(stat_requests.size());
+		bool has_route_requests = false;
+		{
+			bool has_map_requests = false;
+			std::unordered_map<std::string, size_t> first_requests;
+			for (size_t i = 0; i < stat_requests.size(); ++i) {
+				const json::arena::Object request_map = stat_requests[i].AsMap();
+				request_map.at("id").AsInt();
+				const std::string_view type = request_map.at("type").AsString();
+				has_route_requests = has_route_requests || type == "Route"sv;
+				has_map_requests = has_map_requests || type == "Map"sv;
+
+				first_duplicates[i] = i;
+				if (const auto key = detail::MakeRequestKey(request_map)) {
+					const size_t first = first_requests.emplace(*key, i).first->second;
+					first_duplicates[i] = first;
+					duplicates_left[first] += first != i;
 				}
-				else {
-					const std::set<std::string_view>& buses = catalogue_.GetBusesForStop(stop);
-					json::Array buses_resp;
-					for (const auto& bus : buses) {
-						buses_resp.emplace_back(std::string(bus));
+			}
+			if (has_route_requests) {
+				ReadRoutingSettings();
+			}
+			if (has_map_requests) {
+				ProcessRenderRequest(sections_);
+			}
+		}
+		const auto is_duplicate = [&](size_t i) {
+			return first_duplicates[i] != i;
+		};
+		// Ответы, которые ещё понадобятся дубликатам, без значения request_id
+		std::unordered_map<size_t, response_cache::CachedResponse> shared_responses;
+		std::string duplicate_response;
+		request_stats::RequestStats duplicates_stats;
+
+		thread_pool::ThreadPool pool(threads_count_);
+		std::vector<std::unique_ptr<WorkerScratch>> scratches;
+		for (size_t i = 0; i < pool.GetThreadsCount(); ++i) {
+			scratches.push_back(std::make_unique<WorkerScratch>(output.precision(), number_format));
+		}
+
+		const size_t chunks_count = (stat_requests.size() + REQUESTS_PER_CHUNK - 1) / REQUESTS_PER_CHUNK;
+		std::vector<ResponsesChunk> window(std::min(chunks_count, pool.GetThreadsCount() * CHUNKS_PER_THREAD));
+
+		const auto is_route_request = [&](size_t i) {
+			return stat_requests[i].AsMap().at("type").AsString() == "Route"sv;
+		};
+		if (pipeline_ && has_route_requests) {
+			StartTransportRouterBuild();
+		}
+
+		// Запросы, до которых очередь дошла после срока пакета, получают ответ "timeout"
+		const deadline::Deadline batch_deadline = batch_timeout_.count() > 0
+			? deadline::Deadline::After(batch_timeout_)
+			: deadline::Deadline();
+
+		json::Writer writer(output, number_format);
+		writer.StartArray();
+		for (size_t first_chunk = 0; first_chunk < chunks_count; first_chunk += window.size()) {
+			const size_t window_size = std::min(window.size(), chunks_count - first_chunk);
+			const auto write_chunk = [&](Pass pass, size_t worker_index, size_t chunk_index) {
+				WorkerScratch& scratch = *scratches[worker_index];
+				ResponsesChunk& chunk = window[chunk_index];
+
+				const size_t begin = (first_chunk + chunk_index) * REQUESTS_PER_CHUNK;
+				const size_t end = std::min(stat_requests.size(), begin + REQUESTS_PER_CHUNK);
+				if (pass != Pass::ONLY_ROUTES) {
+					chunk.text.clear();
+					chunk.spans.assign(end - begin, {});
+				}
+				const size_t start = scratch.buffer.GetWrittenSize() - chunk.text.size();
+				for (size_t i = begin; i < end; ++i) {
+					if (is_duplicate(i)
+						|| (pass == Pass::WITHOUT_ROUTES && is_route_request(i))
+						|| (pass == Pass::ONLY_ROUTES && !is_route_request(i))) {
+						continue;
 					}
-					dict_context.Key("buses").Value(std::move(buses_resp));
+					ResponseSpan& span = chunk.spans[i - begin];
+					span.begin = scratch.buffer.GetWrittenSize() - start;
+					const WrittenResponse written = WriteCachedStatResponse(stat_requests[i].AsMap(), scratch.buffer,
+						json::Layout::INDENTED, RESPONSE_INDENT, stats_ ? &scratch.stats : nullptr, batch_deadline);
+					span.request_id = written.request_id_span;
+					span.route_edges = written.route_edges;
+					span.end = scratch.buffer.GetWrittenSize() - start;
 				}
+				scratch.buffer.Flush();
+				chunk.text += scratch.stream.str();
+				scratch.stream.str({});
+			};
+
+			// Пока роутер строится в фоне, запросы Route окна откладываются на второй проход
+			if (pipeline_ && !IsTransportRouterReady()) {
+				pool.Run(window_size, [&](size_t worker_index, size_t chunk_index) {
+					write_chunk(Pass::WITHOUT_ROUTES, worker_index, chunk_index);
+					});
+				pool.Run(window_size, [&](size_t worker_index, size_t chunk_index) {
+					write_chunk(Pass::ONLY_ROUTES, worker_index, chunk_index);
+					});
+			}
+			else {
+				pool.Run(window_size, [&](size_t worker_index, size_t chunk_index) {
+					write_chunk(Pass::ALL, worker_index, chunk_index);
+					});
 			}
 
-			// "Bus" command
-			if (request_map.at("type").AsString() == "Bus") {
-				BusInfo bus_info = catalogue_.GetBusInfo(request_map.at("name").AsString());
+			for (size_t chunk_index = 0; chunk_index < window_size; ++chunk_index) {
+				const ResponsesChunk& chunk = window[chunk_index];
+				const std::string_view text = chunk.text;
+				for (size_t span_index = 0; span_index < chunk.spans.size(); ++span_index) {
+					const size_t i = (first_chunk + chunk_index) * REQUESTS_PER_CHUNK + span_index;
+					const ResponseSpan& span = chunk.spans[span_index];
+					if (!is_duplicate(i)) {
+						const std::string_view response = text.substr(span.begin, span.end - span.begin);
+						writer.RawValue(response);
+						if (duplicates_left[i] > 0) {
+							const size_t id_end = span.request_id.second;
+							shared_responses[i] = {
+								std::string(response.substr(0, span.request_id.first)).append(response.substr(id_end)),
+								span.request_id.first,
+								span.route_edges
+							};
+						}
+						continue;
+					}
 
-				if (!bus_info.bus_found) {
-					dict_context.Key("error_message").Value("not found"s);
+					const size_t first = first_duplicates[i];
+					const json::arena::Object request_map = stat_requests[i].AsMap();
+					const response_cache::CachedResponse& shared = shared_responses.at(first);
+					{
+						// Дубликат учитывается в статистике как отдельный ответ
+						const request_stats::ScopedLatency latency(stats_ ? &duplicates_stats : nullptr,
+							request_map.at("type").AsString());
+						const std::string_view shared_text = shared.text;
+						duplicate_response.assign(shared_text.substr(0, shared.id_offset))
+							.append(std::to_string(request_map.at("id").AsInt()))
+							.append(shared_text.substr(shared.id_offset));
+						if (stats_ && shared.route_edges) {
+							duplicates_stats.RecordRouteEdges(*shared.route_edges);
+						}
+					}
+					writer.RawValue(duplicate_response);
+					if (--duplicates_left[first] == 0) {
+						shared_responses.erase(first);
+					}
 				}
-				else {
-					dict_context.Key("curvature").Value(bus_info.curvature)
-						.Key("route_length").Value(static_cast<double>(bus_info.route_length))
-						.Key("stop_count").Value(static_cast<int>(bus_info.stops_count))
-						.Key("unique_stop_count").Value(static_cast<int>(bus_info.unique_stops_count));
+			}
+		}
+		writer.EndArray();
+		writer.Finish();
+
+		if (stats_) {
+			for (const auto& scratch : scratches) {
+				stats_->Merge(scratch->stats);
+			}
+			stats_->Merge(duplicates_stats);
+		}
+	}
+
+	// В кеше хранится ответ без значения request_id, оно подставляется при выводе
+	JsonReader::WrittenResponse JsonReader::WriteCachedStatResponse(const json::arena::Object& request_map,
+		json::OutputBuffer& output, json::Layout layout, int indent, request_stats::RequestStats* stats,
+		const deadline::Deadline& batch_deadline) const {
+		const int request_id = request_map.at("id").AsInt();
+		const std::string_view type = request_map.at("type").AsString();
+		const request_stats::ScopedLatency latency(stats, type);
+		const trace::ScopedSpan span(request_stats::GetRequestTypeName(request_stats::GetRequestType(type)),
+			"request", request_id);
+		const std::optional<std::string> key = response_cache_->IsEnabled()
+			? detail::MakeResponseCacheKey(request_map, output, layout, indent)
+			: std::nullopt;
+		const deadline::Deadline deadline = request_timeout_.count() > 0
+			? batch_deadline.Earliest(deadline::Deadline::After(request_timeout_))
+			: batch_deadline;
+		const size_t start = output.GetWrittenSize();
+		if (!key) {
+			json::Writer writer(output, layout, indent);
+			WrittenResponse written = WriteStatResponse(request_map, writer, stats, deadline);
+			writer.Finish();
+			written.request_id_span.first -= start;
+			written.request_id_span.second -= start;
+			return written;
+		}
+
+		const uint64_t version = catalogue_.GetVersion();
+		if (const auto cached = response_cache_->Find(*key, version)) {
+			const std::string_view text = cached->text;
+			output.Write(text.substr(0, cached->id_offset));
+			output.WriteInt(request_id);
+			const size_t id_end = output.GetWrittenSize() - start;
+			output.Write(text.substr(cached->id_offset));
+			if (stats && cached->route_edges) {
+				stats->RecordRouteEdges(*cached->route_edges);
+			}
+			return { { cached->id_offset, id_end }, false, cached->route_edges };
+		}
+
+		constexpr size_t RESPONSE_BUFFER_CAPACITY = 1 << 10;
+		std::ostringstream stream;
+		WrittenResponse written;
+		{
+			json::OutputBuffer buffer(detail::SetPrecision(stream, output.GetPrecision()), output.GetNumberFormat(),
+				RESPONSE_BUFFER_CAPACITY);
+			json::Writer writer(buffer, layout, indent);
+			written = WriteStatResponse(request_map, writer, stats, deadline);
+			writer.Finish();
+		}
+		std::string text = stream.str();
+		output.Write(text);
+
+		if (written.timed_out) {
+			return written;
+		}
+
+		const auto [id_begin, id_end] = written.request_id_span;
+		text.erase(id_begin, id_end - id_begin);
+		response_cache_->Insert(std::move(*key), version, { std::move(text), id_begin, written.route_edges });
+		return written;
+	}
+
+	// Ключи ответа выводятся в порядке json::Dict
+	JsonReader::WrittenResponse JsonReader::WriteStatResponse(const json::arena::Object& request_map,
+		json::Writer& writer, request_stats::RequestStats* stats, const deadline::Deadline& deadline) const {
+		const int request_id = request_map.at("id").AsInt();
+		const std::string_view type = request_map.at("type").AsString();
+
+		auto dict_context = writer.StartDict();
+		std::pair<size_t, size_t> request_id_span;
+		std::optional<size_t> route_edges;
+		const auto write_request_id = [&](auto context) {
+			auto value_context = context.Key("request_id");
+			request_id_span.first = writer.GetWrittenSize();
+			auto item_context = value_context.Value(request_id);
+			request_id_span.second = writer.GetWrittenSize();
+			return item_context;
+		};
+		// Срок проверяется до вывода ключей, поэтому прерванный ответ остаётся корректным JSON
+		const auto write_timeout = [&] {
+			write_request_id(dict_context.Key("error_message").Value("timeout"sv));
+			dict_context.EndDict();
+			return WrittenResponse{ request_id_span, true, std::nullopt };
+		};
+		if (deadline.IsExpired()) {
+			return write_timeout();
+		}
+
+		// "Map" command
+		if (type == "Map") {
+			std::shared_ptr<const std::string> map_json;
+			try {
+				map_json = GetMapJson(deadline);
+			}
+			catch (const deadline::DeadlineExceeded&) {
+				return write_timeout();
+			}
+			dict_context.Key("map");
+			writer.RawValue(*map_json);
+			write_request_id(dict_context);
+		}
+
+		// "Stop" command
+		else if (type == "Stop") {
+			const Stop* stop = catalogue_.FindStop(request_map.at("name").AsString());
+			if (!stop) {
+				dict_context.Key("error_message").Value("not found"sv);
+			}
+			else {
+				auto buses_context = dict_context.Key("buses").StartArray();
+				for (const auto& bus : catalogue_.GetBusesForStop(stop)) {
+					buses_context.Value(bus);
 				}
+				buses_context.EndArray();
+			}
+			write_request_id(dict_context);
+		}
+
+		// "Bus" command
+		else if (type == "Bus") {
+			BusInfo bus_info = catalogue_.GetBusInfo(request_map.at("name").AsString());
+
+			if (!bus_info.bus_found) {
+				write_request_id(dict_context.Key("error_message").Value("not found"sv));
+			}
+			else {
+				write_request_id(dict_context.Key("curvature").Value(bus_info.curvature))
+					.Key("route_length").Value(static_cast<double>(bus_info.route_length))
+					.Key("stop_count").Value(static_cast<int>(bus_info.stops_count))
+					.Key("unique_stop_count").Value(static_cast<int>(bus_info.unique_stops_count));
 			}
+		}
 
-			// "Route" command
-			if (request_map.at("type").AsString() == "Route") {
-				const auto& route_data = transport_router_->FindRoute(
+		// "Route" command
+		else if (type == "Route") {
+			std::optional<transport_router::RouteData> route_data;
+			try {
+				route_data = WaitTransportRouter(deadline).FindRoute(
 					request_map.at("from").AsString(),
-					request_map.at("to").AsString()
+					request_map.at("to").AsString(),
+					deadline
 				);
+			}
+			catch (const deadline::DeadlineExceeded&) {
+				return write_timeout();
+			}
 
-				if (!route_data) {
-					dict_context.Key("error_message").Value("not found"s);
+			if (!route_data) {
+				write_request_id(dict_context.Key("error_message").Value("not found"sv));
+			}
+			else {
+				// Каждый переход по маршруту - пара элементов Wait и Bus
+				route_edges = route_data->items.size() / 2;
+				if (stats) {
+					stats->RecordRouteEdges(*route_edges);
 				}
-				else {
-					dict_context.Key("total_time").Value(route_data->total_time);
-
-					json::Array items;
-					for (const auto& item : route_data->items) {
-						json::Dict val;
-						if (item.type == transport_router::RouteItems::Type::Wait) {
-							val["type"] = "Wait";
-							val["stop_name"] = item.stop_name;
-						}
-						else if (item.type == transport_router::RouteItems::Type::Bus) {
-							val["type"] = "Bus";
-							val["bus"] = item.bus_name;
-							val["span_count"] = static_cast<int>(item.span_count);
-						}
-						val["time"] = item.time;
-						items.push_back(std::move(val));
+				auto items_context = dict_context.Key("items").StartArray();
+				for (const auto& item : route_data->items) {
+					auto item_context = items_context.StartDict();
+					if (item.type == transport_router::RouteItems::Type::Wait) {
+						item_context.Key("stop_name").Value(item.stop_name)
+							.Key("time").Value(item.time)
+							.Key("type").Value("Wait"sv);
+					}
+					else if (item.type == transport_router::RouteItems::Type::Bus) {
+						item_context.Key("bus").Value(item.bus_name)
+							.Key("span_count").Value(static_cast<int>(item.span_count))
+							.Key("time").Value(item.time)
+							.Key("type").Value("Bus"sv);
 					}
-					dict_context.Key("items").Value(std::move(items));
+					item_context.EndDict();
 				}
+				items_context.EndArray();
+				write_request_id(dict_context)
+					.Key("total_time").Value(route_data->total_time);
 			}
+		}
 
-			dict_context.EndDict();
-			result.emplace_back(response.Build());
+		else {
+			write_request_id(dict_context);
 		}
 
-		return result;
+		dict_context.EndDict();
+		return { request_id_span, false, route_edges };
 	}
 
-	map_renderer::RenderSettings JsonReader::ProcessRenderRequest(const json::Document& doc) const {
-		const json::Dict& render_settings = doc.GetRoot()
+	map_renderer::RenderSettings JsonReader::ProcessRenderRequest(const json::arena::Document& doc) const {
+		const json::arena::Object render_settings = doc.GetRoot()
 			.AsMap().at("render_settings").AsMap();
 
 		return {
@@ -249,15 +999,98 @@ namespace transport_catalogue {
 		};
 	}
 
+	transport_router::RoutingSettings JsonReader::ReadRoutingSettings() const {
+		const json::arena::Object routing_settings = sections_.GetRoot()
+			.AsMap().at("routing_settings").AsMap();
+
+		return {
+			routing_settings.at("bus_wait_time").AsInt(),
+			routing_settings.at("bus_velocity").AsDouble()
+		};
+	}
+
 	void JsonReader::ParseInput(std::istream& input) {
-		json::Document doc = json::Load(input);
-		ProcessBaseRequests(doc);
-		InitializeTransportRouter(doc);
-		stat_responses_ = ProcessStatRequests(doc);
+		std::string buffer;
+		{
+			const profiler::ScopedPhase phase("read_input");
+			buffer = json::ReadAll(input);
+		}
+		ParseInput(std::move(buffer));
+	}
+
+	void JsonReader::ParseInput(std::string input) {
+		auto buffer = std::make_shared<const std::string>(std::move(input));
+		ParseBuffer(buffer, *buffer);
+	}
+
+	void JsonReader::ParseFile(const std::string& path) {
+		std::shared_ptr<const mapped_file::MappedFile> file;
+		{
+			const profiler::ScopedPhase phase("map_input");
+			file = std::make_shared<const mapped_file::MappedFile>(path);
+		}
+		ParseBuffer(file, file->GetData());
+	}
+
+	void JsonReader::ParseBuffer(std::shared_ptr<const void> owner, std::string_view input) {
+		// Строки секций и названия в справочнике ссылаются на входные данные,
+		// поэтому буфер хранится вместе с ними
+		input_owner_ = owner;
+		catalogue_.AddNameSource(std::move(owner), input);
+		InputHandler handler(catalogue_, input);
+		{
+			// Запросы base_requests применяются к справочнику по ходу разбора
+			const profiler::ScopedPhase phase("parse_input");
+			json::Parse(input, handler);
+		}
+		{
+			const profiler::ScopedPhase phase("build_indexes");
+			catalogue_.BuildIndexes();
+		}
+
+		sections_ = handler.ExtractSections();
+		lazy_objects_ = std::make_unique<LazyObjects>();
+		// Ответы Route зависят от настроек маршрутизации, которые могли измениться
+		response_cache_->Clear();
+	}
+
+	void JsonReader::PrintOutput(std::ostream& output, json::NumberFormat number_format) const {
+		WriteStatResponses(sections_.GetRoot().AsMap().at("stat_requests").AsArray(), output, number_format);
+	}
+
+	void JsonReader::PrintResponses(const json::arena::Array& stat_requests, std::ostream& output,
+		json::NumberFormat number_format) const {
+		WriteStatResponses(stat_requests, output, number_format);
 	}
 
-	void JsonReader::PrintOutput(std::ostream& output) const {
-		json::Print(json::Document{ stat_responses_ }, output);
+	void JsonReader::ProcessNdjsonRequests(std::istream& input, std::ostream& output,
+		json::NumberFormat number_format) const {
+		if (pipeline_) {
+			StartTransportRouterBuild();
+		}
+		std::string line;
+		std::ostringstream response;
+		while (std::getline(input, line)) {
+			if (line.find_first_not_of(" \t\r"sv) == std::string::npos) {
+				continue;
+			}
+			// Ответ собирается целиком, чтобы ошибка в запросе не оставила в выводе неполную строку
+			response.str({});
+			try {
+				const json::arena::Document request = json::arena::Load(line);
+				json::OutputBuffer buffer(response, number_format);
+				WriteCachedStatResponse(request.GetRoot().AsMap(), buffer, json::Layout::COMPACT, 0, stats_.get(), {});
+			}
+			catch (const std::exception& e) {
+				response.str({});
+				json::Writer writer(response, number_format, json::Layout::COMPACT);
+				writer.StartDict().Key("error_message").Value(e.what()).EndDict();
+				writer.Finish();
+			}
+			response.put('\n');
+			output << response.str();
+			output.flush();
+		}
 	}
 
 } // namespace transport_catalogue
\ No newline at end of file
@@ -1,11 +1,22 @@
 #pragma once
 
+#include <chrono>
+#include <future>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
 
+#include "deadline.h"
 #include "json.h"
+#include "json_arena.h"
+#include "json_writer.h"
 #include "transport_catalogue.h"
 #include "map_renderer.h"
 #include "request_handler.h"
+#include "request_stats.h"
+#include "response_cache.h"
 #include "transport_router.h"
 
 
@@ -13,20 +24,101 @@ namespace transport_catalogue {
 
 	class JsonReader {
 	public:
+		static constexpr size_t DEFAULT_CACHE_CAPACITY = 1 << 16;
+
 		JsonReader(TransportCatalogue& catalogue);
 
 		void ParseInput(std::istream& input);
-		void PrintOutput(std::ostream& output) const;
+		void ParseInput(std::string input);
+		// Разбирает файл, отображённый в память, без копирования строк
+		void ParseFile(const std::string& path);
+		// Число потоков для ответов на stat_requests, 0 - по числу ядер
+		void SetThreadsCount(size_t threads_count);
+		// Строить роутер в фоновом потоке, пока отвечают запросы, которым он не нужен
+		void SetPipeline(bool pipeline);
+		// Время на ответ на один запрос и на весь пакет stat_requests, 0 - без ограничения.
+		// Запрос, не уложившийся в срок, получает ответ с error_message "timeout"
+		void SetRequestTimeout(std::chrono::milliseconds timeout);
+		void SetBatchTimeout(std::chrono::milliseconds timeout);
+		// Число ответов на запросы Bus, Stop и Route, хранимых в кеше, 0 отключает кеш
+		void SetCacheCapacity(size_t capacity);
+		const response_cache::ResponseCache& GetResponseCache() const;
+		// Включает сбор задержек ответов по типам запросов и счётчиков маршрутизации
+		void EnableStats();
+		// Выводит собранную статистику в формате JSON. Повторы запроса в пакете и ответы
+		// из кеша учитываются как отдельные ответы, в том числе в числе найденных маршрутов
+		void PrintStats(std::ostream& output) const;
+		void PrintOutput(std::ostream& output,
+			json::NumberFormat number_format = json::NumberFormat::STREAM_PRECISION) const;
+		// Отвечает на запросы из другого документа в формате stat_requests.
+		// Если статистика не включена, можно вызывать из нескольких потоков одновременно
+		void PrintResponses(const json::arena::Array& stat_requests, std::ostream& output,
+			json::NumberFormat number_format = json::NumberFormat::STREAM_PRECISION) const;
+		// Режим NDJSON: каждая непустая строка input - один запрос в формате stat_requests.
+		// Ответ выводится одной строкой сразу после вычисления, stat_requests из входных данных не используются
+		void ProcessNdjsonRequests(std::istream& input, std::ostream& output,
+			json::NumberFormat number_format = json::NumberFormat::STREAM_PRECISION) const;
 
 	private:
-		void ProcessBaseRequests(const json::Document& doc);
-		json::Array ProcessStatRequests(const json::Document& doc) const;
-		map_renderer::RenderSettings ProcessRenderRequest(const json::Document& doc) const;
-		void InitializeTransportRouter(const json::Document& doc);
+		void ParseBuffer(std::shared_ptr<const void> owner, std::string_view input);
+		void WriteStatResponses(const json::arena::Array& stat_requests, std::ostream& output,
+			json::NumberFormat number_format) const;
+		struct WrittenResponse {
+			std::pair<size_t, size_t> request_id_span; // границы значения request_id в выводе
+			bool timed_out = false;
+			std::optional<size_t> route_edges; // число рёбер найденного маршрута
+		};
+
+		// Ответ берётся из кеша или вычисляется и добавляется в него.
+		// Если stats не nullptr, в него записывается время ответа. Срок ответа - более ранний
+		// из batch_deadline и времени на один запрос.
+		// Границы значения request_id возвращаются относительно начала ответа
+		WrittenResponse WriteCachedStatResponse(const json::arena::Object& request_map,
+			json::OutputBuffer& output, json::Layout layout, int indent, request_stats::RequestStats* stats,
+			const deadline::Deadline& batch_deadline) const;
+		WrittenResponse WriteStatResponse(const json::arena::Object& request_map, json::Writer& writer,
+			request_stats::RequestStats* stats, const deadline::Deadline& deadline) const;
+		map_renderer::RenderSettings ProcessRenderRequest(const json::arena::Document& doc) const;
+		transport_router::RoutingSettings ReadRoutingSettings() const;
+		// Настройки отрисовки и маршрутизации разбираются, а роутер строится
+		// при первом запросе, которому они нужны
+		const map_renderer::MapRenderer& GetMapRenderer() const;
+		// Карта отрисовывается один раз для текущей версии справочника.
+		// Прерванная по сроку отрисовка не сохраняется
+		std::shared_ptr<const std::string> GetMapJson(const deadline::Deadline& deadline) const;
+		const transport_router::TransportRouter& GetTransportRouter() const;
+		// Дожидается фонового построения роутера не дольше deadline
+		const transport_router::TransportRouter& WaitTransportRouter(const deadline::Deadline& deadline) const;
+		void StartTransportRouterBuild() const;
+		// Роутер построен или фоновое построение не запускалось
+		bool IsTransportRouterReady() const;
+
+		// Создаются при первом обращении и пересоздаются при разборе новых входных данных
+		struct LazyObjects {
+			std::once_flag map_renderer_flag;
+			std::optional<map_renderer::MapRenderer> map_renderer;
+			std::once_flag transport_router_flag;
+			std::optional<transport_router::TransportRouter> transport_router;
+			// Карта, сериализованная как строка JSON, и версия справочника, по которой она построена.
+			// Настройки отрисовки входят в ключ неявно: при их смене объект пересоздаётся
+			std::timed_mutex map_mutex;
+			std::optional<uint64_t> map_version;
+			std::shared_ptr<const std::string> map_json;
+			// Фоновое построение роутера. Объявлено последним, чтобы при разрушении
+			// дождаться завершения потока раньше, чем будут разрушены остальные поля
+			std::shared_future<void> transport_router_ready;
+		};
 
 		TransportCatalogue& catalogue_;
-		json::Array stat_responses_;
-		std::optional<transport_router::TransportRouter> transport_router_;
+		std::shared_ptr<const void> input_owner_;
+		json::arena::Document sections_;
+		std::unique_ptr<LazyObjects> lazy_objects_ = std::make_unique<LazyObjects>();
+		size_t threads_count_ = 0;
+		bool pipeline_ = false;
+		std::chrono::milliseconds request_timeout_{ 0 };
+		std::chrono::milliseconds batch_timeout_{ 0 };
+		std::unique_ptr<response_cache::ResponseCache> response_cache_;
+		std::unique_ptr<request_stats::RequestStats> stats_;
 	};
 
 } // namespace transport_catalogue
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include "json_writer.h"
+
+namespace json {
+
+	using namespace std::string_literals;
+	using namespace std::string_view_literals;
+
+	namespace {
+		constexpr int INDENT_STEP = 4;
+	} // namespace
+
+	// === class Writer ===
+	Writer::Writer(std::ostream& output, NumberFormat number_format, Layout layout)
+		: owned_output_(std::make_unique<OutputBuffer>(output, number_format))
+		, output_(*owned_output_)
+		, layout_(layout) {
+	}
+
+	Writer::Writer(OutputBuffer& output, Layout layout, int indent)
+		: output_(output)
+		, layout_(layout)
+		, indent_(indent) {
+	}
+
+	void Writer::Finish() {
+		if (!frames_.empty()) {
+			throw std::logic_error("JSON object is incomplete"s);
+		}
+		if (!is_root_written_) {
+			throw std::logic_error("JSON object is not set"s);
+		}
+		// Чужой буфер сбрасывает его владелец
+		if (owned_output_) {
+			output_.Flush();
+		}
+	}
+
+	Writer::DictValueContext Writer::Key(std::string key) {
+		if (frames_.empty() || !frames_.back().is_dict || frames_.back().has_key) {
+			throw std::logic_error("Key called outside of the Dict"s);
+		}
+		Frame& frame = frames_.back();
+		PrintSeparator(frame);
+		output_.WriteString(key);
+		output_.Write(layout_ == Layout::COMPACT ? ":"sv : ": "sv);
+		frames_.back().has_key = true;
+		return DictValueContext(*this);
+	}
+
+	Writer::BaseContext Writer::Value(std::string_view value) {
+		StartItem();
+		output_.WriteString(value);
+		EndItem();
+		return BaseContext(*this);
+	}
+
+	Writer::BaseContext Writer::Value(const std::string& value) {
+		return Value(std::string_view(value));
+	}
+
+	Writer::BaseContext Writer::Value(const char* value) {
+		return Value(std::string_view(value));
+	}
+
+	Writer::BaseContext Writer::Value(int value) {
+		StartItem();
+		output_.WriteInt(value);
+		EndItem();
+		return BaseContext(*this);
+	}
+
+	Writer::BaseContext Writer::Value(double value) {
+		StartItem();
+		output_.WriteDouble(value);
+		EndItem();
+		return BaseContext(*this);
+	}
+
+	Writer::BaseContext Writer::Value(bool value) {
+		StartItem();
+		output_.Write(value ? "true"sv : "false"sv);
+		EndItem();
+		return BaseContext(*this);
+	}
+
+	Writer::BaseContext Writer::Value(const Node::Value& value) {
+		StartItem();
+		PrintNode(Node(value), output_, GetIndent(), layout_);
+		EndItem();
+		return BaseContext(*this);
+	}
+
+	Writer::BaseContext Writer::RawValue(std::string_view text) {
+		StartItem();
+		output_.Write(text);
+		EndItem();
+		return BaseContext(*this);
+	}
+
+	size_t Writer::GetWrittenSize() const {
+		return output_.GetWrittenSize();
+	}
+
+	Writer::DictItemContext Writer::StartDict() {
+		StartContainer(/* is_dict = */ true, '{');
+		return DictItemContext{ *this };
+	}
+
+	Writer::ArrayItemContext Writer::StartArray() {
+		StartContainer(/* is_dict = */ false, '[');
+		return ArrayItemContext{ *this };
+	}
+
+	Writer::BaseContext Writer::EndDict() {
+		if (frames_.empty() || !frames_.back().is_dict || frames_.back().has_key) {
+			throw std::logic_error("EndDict called outside of the Dict");
+		}
+		EndContainer('}');
+		return BaseContext(*this);
+	}
+
+	Writer::BaseContext Writer::EndArray() {
+		if (frames_.empty() || frames_.back().is_dict) {
+			throw std::logic_error("EndArray called outside of the Array");
+		}
+		EndContainer(']');
+		return BaseContext(*this);
+	}
+
+	int Writer::GetIndent() const {
+		return layout_ == Layout::COMPACT ? 0 : indent_ + static_cast<int>(frames_.size()) * INDENT_STEP;
+	}
+
+	void Writer::PrintLineBreak() {
+		if (layout_ != Layout::COMPACT) {
+			output_.Put('\n');
+		}
+	}
+
+	// Разделитель и отступ перед очередным элементом контейнера
+	void Writer::PrintSeparator(Frame& frame) {
+		if (frame.items_count > 0) {
+			output_.Put(',');
+			PrintLineBreak();
+		}
+		++frame.items_count;
+		output_.WriteIndent(GetIndent());
+	}
+
+	// Значение после ключа словаря пишется в той же строке, что и ключ
+	void Writer::StartItem() {
+		if (frames_.empty()) {
+			if (is_root_written_) {
+				throw std::logic_error("Node stack is empty, all containers are closed"s);
+			}
+			is_root_written_ = true;
+			return;
+		}
+		Frame& frame = frames_.back();
+		if (frame.is_dict) {
+			if (!frame.has_key) {
+				throw std::logic_error("AddNode called in invalid context");
+			}
+			return;
+		}
+		PrintSeparator(frame);
+	}
+
+	void Writer::EndItem() {
+		if (!frames_.empty()) {
+			frames_.back().has_key = false;
+		}
+	}
+
+	void Writer::StartContainer(bool is_dict, char bracket) {
+		StartItem();
+		EndItem();
+		output_.Put(bracket);
+		PrintLineBreak();
+		frames_.push_back({ is_dict });
+	}
+
+	void Writer::EndContainer(char bracket) {
+		frames_.pop_back();
+		PrintLineBreak();
+		output_.WriteIndent(GetIndent());
+		output_.Put(bracket);
+	}
+
+	// === class BaseContext ===
+	Writer::BaseContext::BaseContext(Writer& writer) :
+		writer_(writer) {
+	}
+	void Writer::BaseContext::Finish() {
+		writer_.Finish();
+	}
+	Writer::DictValueContext Writer::BaseContext::Key(std::string key) {
+		return writer_.Key(std::move(key));
+	}
+	Writer::DictItemContext Writer::BaseContext::StartDict() {
+		return writer_.StartDict();
+	}
+	Writer::ArrayItemContext Writer::BaseContext::StartArray() {
+		return writer_.StartArray();
+	}
+	Writer::BaseContext Writer::BaseContext::EndDict() {
+		return writer_.EndDict();
+	}
+	Writer::BaseContext Writer::BaseContext::EndArray() {
+		return writer_.EndArray();
+	}
+
+	// === class DictValueContext ===
+	Writer::DictValueContext::DictValueContext(Writer& writer)
+		: BaseContext(writer) {
+	}
+
+	// === class DictItemContext ===
+	Writer::DictItemContext::DictItemContext(BaseContext base)
+		: BaseContext(base) {
+	}
+
+	// === class ArrayItemContext ===
+	Writer::ArrayItemContext::ArrayItemContext(BaseContext base)
+		: BaseContext(base) {
+	}
+
+} // namespace json
\ No newline at end of file
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "json.h"
+
+namespace json {
+
+	// Потоковый вывод JSON с тем же контролем контекста, что и у json::Builder.
+	// Элементы пишутся в буфер вывода сразу, без построения дерева, в формате json::Print.
+	// Ключи словаря выводятся в порядке вызовов Key, поэтому для совпадения
+	// с json::Print их следует передавать в алфавитном порядке
+	class Writer {
+	private:
+		class BaseContext;
+		class DictValueContext;
+		class DictItemContext;
+		class ArrayItemContext;
+
+	public:
+		explicit Writer(std::ostream& output,
+			NumberFormat number_format = NumberFormat::STREAM_PRECISION, Layout layout = Layout::INDENTED);
+		// Вывод в чужой буфер; документ печатается так, будто он вложен с отступом indent
+		explicit Writer(OutputBuffer& output, Layout layout = Layout::INDENTED, int indent = 0);
+		void Finish();
+		DictValueContext Key(std::string key);
+		// Скалярные значения выводятся без построения json::Node
+		BaseContext Value(std::string_view value);
+		BaseContext Value(const std::string& value);
+		BaseContext Value(const char* value);
+		BaseContext Value(int value);
+		BaseContext Value(double value);
+		BaseContext Value(bool value);
+		BaseContext Value(const Node::Value& value);
+		DictItemContext StartDict();
+		ArrayItemContext StartArray();
+		BaseContext EndDict();
+		BaseContext EndArray();
+		// Значение, уже сериализованное с отступом текущего уровня вложенности
+		BaseContext RawValue(std::string_view text);
+		// Число символов, выведенных в буфер, включая записанные до создания Writer
+		size_t GetWrittenSize() const;
+
+	private:
+		struct Frame {
+			bool is_dict;
+			size_t items_count = 0;
+			bool has_key = false;
+		};
+
+		std::unique_ptr<OutputBuffer> owned_output_;
+		OutputBuffer& output_;
+		Layout layout_;
+		int indent_ = 0;
+		std::vector<Frame> frames_;
+		bool is_root_written_ = false;
+
+		int GetIndent() const;
+		void PrintLineBreak();
+		void PrintSeparator(Frame& frame);
+		void StartItem();
+		void EndItem();
+		void StartContainer(bool is_dict, char bracket);
+		void EndContainer(char bracket);
+
+		class BaseContext {
+		public:
+			BaseContext(Writer& writer);
+			void Finish();
+			DictValueContext Key(std::string key);
+			template <typename T>
+			BaseContext Value(T&& value) {
+				return writer_.Value(std::forward<T>(value));
+			}
+			DictItemContext StartDict();
+			ArrayItemContext StartArray();
+			BaseContext EndDict();
+			BaseContext EndArray();
+		private:
+			Writer& writer_;
+		};
+
+		class DictValueContext : public BaseContext {
+		public:
+			DictValueContext(Writer& writer);
+			template <typename T>
+			DictItemContext Value(T&& value) {
+				return BaseContext::Value(std::forward<T>(value));
+			}
+			void Finish() = delete;
+			DictValueContext Key(std::string key) = delete;
+			BaseContext EndDict() = delete;
+			BaseContext EndArray() = delete;
+		};
+
+		class DictItemContext : public BaseContext {
+		public:
+			DictItemContext(BaseContext base);
+			void Finish() = delete;
+			template <typename T>
+			BaseContext Value(T&& value) = delete;
+			BaseContext EndArray() = delete;
+			DictItemContext StartDict() = delete;
+			ArrayItemContext StartArray() = delete;
+		};
+
+		class ArrayItemContext : public BaseContext {
+		public:
+			ArrayItemContext(BaseContext base);
+			template <typename T>
+			ArrayItemContext Value(T&& value) {
+				return BaseContext::Value(std::forward<T>(value));
+			}
+			void Finish() = delete;
+			DictValueContext Key(std::string key) = delete;
+			BaseContext EndDict() = delete;
+		};
+	};
+
+}  // namespace json
\ No newline at end of file
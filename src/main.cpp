@@ -1,17 +1,183 @@
+#include <chrono>
+#include <fstream>
 #include <iostream>
+#include <string>
+#include <string_view>
 
+#include "base_binary.h"
 #include "transport_catalogue.h"
 #include "json_reader.h"
+#include "profiler.h"
+#include "server.h"
+#include "trace.h"
 
-int main() {
+using namespace std::literals;
+
+namespace {
+
+    struct Options {
+        std::string input_path; // пустой путь — чтение из stdin
+        bool ndjson = false;    // запросы построчно из stdin после загрузки базы из input_path
+        std::string base_path;  // двоичная база, загружаемая до разбора JSON
+        std::string serve_path;  // сокет Unix для режима сервера, база загружается из input_path
+        std::string convert_from; // преобразование базы из JSON в двоичный формат
+        std::string convert_to;
+        size_t threads_count = 0; // 0 — по числу ядер
+        bool pipeline = false;  // построение роутера в фоне во время ответов на запросы
+        std::chrono::milliseconds request_timeout{ 0 }; // 0 — без ограничения
+        std::chrono::milliseconds batch_timeout{ 0 };
+        size_t cache_capacity = transport_catalogue::JsonReader::DEFAULT_CACHE_CAPACITY; // 0 — без кеша ответов
+        bool stats = false;     // статистика ответов в stderr после обработки
+        bool profile = false;   // время и память по этапам в stderr
+        std::string trace_path; // трасса этапов и запросов в формате Chrome trace event
+    };
+
+    const std::string USAGE = "Usage: transport-catalogue [--base <file.bin>] [--input <file>] [--ndjson] [--threads <n>] [--pipeline]\n"
+        "                           [--cache <entries>] [--request-timeout <ms>] [--batch-timeout <ms>]\n"
+        "                           [--stats] [--profile] [--trace <file.json>]\n"
+        "       transport-catalogue --serve <socket> [--base <file.bin>] --input <file> [--threads <n>] [--cache <entries>]\n"
+        "                           [--request-timeout <ms>] [--batch-timeout <ms>]\n"
+        "       transport-catalogue --convert <input.json> <output.bin>"s;
+
+    Options ParseOptions(int argc, char* argv[]) {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            if (arg == "--input"sv && i + 1 < argc) {
+                options.input_path = argv[++i];
+            }
+            else if (arg == "--ndjson"sv) {
+                options.ndjson = true;
+            }
+            else if (arg == "--base"sv && i + 1 < argc) {
+                options.base_path = argv[++i];
+            }
+            else if (arg == "--threads"sv && i + 1 < argc) {
+                options.threads_count = std::stoul(argv[++i]);
+            }
+            else if (arg == "--pipeline"sv) {
+                options.pipeline = true;
+            }
+            else if (arg == "--cache"sv && i + 1 < argc) {
+                options.cache_capacity = std::stoul(argv[++i]);
+            }
+            else if (arg == "--request-timeout"sv && i + 1 < argc) {
+                options.request_timeout = std::chrono::milliseconds(std::stoul(argv[++i]));
+            }
+            else if (arg == "--batch-timeout"sv && i + 1 < argc) {
+                options.batch_timeout = std::chrono::milliseconds(std::stoul(argv[++i]));
+            }
+            else if (arg == "--stats"sv) {
+                options.stats = true;
+            }
+            else if (arg == "--profile"sv) {
+                options.profile = true;
+            }
+            else if (arg == "--trace"sv && i + 1 < argc) {
+                options.trace_path = argv[++i];
+            }
+            else if (arg == "--serve"sv && i + 1 < argc) {
+                options.serve_path = argv[++i];
+            }
+            else if (arg == "--convert"sv && i + 2 < argc) {
+                options.convert_from = argv[++i];
+                options.convert_to = argv[++i];
+            }
+            else {
+                throw std::invalid_argument("Unknown argument: "s + std::string(arg) + "\n"s + USAGE);
+            }
+        }
+        if (options.ndjson && options.input_path.empty()) {
+            throw std::invalid_argument("--ndjson requires --input <file>\n"s + USAGE);
+        }
+        if (!options.serve_path.empty() && options.input_path.empty()) {
+            throw std::invalid_argument("--serve requires --input <file>\n"s + USAGE);
+        }
+        return options;
+    }
+
+    void ConvertBase(const Options& options) {
+        using namespace transport_catalogue;
+
+        TransportCatalogue catalogue;
+        JsonReader json_reader(catalogue);
+        json_reader.ParseFile(options.convert_from);
+
+        std::ofstream output(options.convert_to, std::ios::binary);
+        if (!output) {
+            throw std::runtime_error("Cannot open file '"s + options.convert_to + "'"s);
+        }
+        const profiler::ScopedPhase phase("write_base");
+        base_binary::WriteBase(catalogue, output);
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
     using namespace transport_catalogue;
 
     TransportCatalogue catalogue;
     JsonReader json_reader(catalogue);
 
     try {
-        json_reader.ParseInput(std::cin);
-        json_reader.PrintOutput(std::cout);
+        const Options options = ParseOptions(argc, argv);
+        json_reader.SetThreadsCount(options.threads_count);
+        json_reader.SetPipeline(options.pipeline);
+        json_reader.SetCacheCapacity(options.cache_capacity);
+        json_reader.SetRequestTimeout(options.request_timeout);
+        json_reader.SetBatchTimeout(options.batch_timeout);
+        if (options.profile) {
+            profiler::Enable();
+        }
+        if (!options.trace_path.empty()) {
+            trace::Start(options.trace_path);
+        }
+        if (options.stats) {
+            json_reader.EnableStats();
+        }
+        if (!options.convert_from.empty()) {
+            ConvertBase(options);
+            trace::Finish();
+            if (options.profile) {
+                profiler::PrintReport(std::cerr);
+            }
+            return 0;
+        }
+        if (!options.serve_path.empty()) {
+            server::Server server({ options.serve_path, options.base_path, options.input_path,
+                options.threads_count, options.cache_capacity, options.request_timeout, options.batch_timeout });
+            server.Run();
+            return 0;
+        }
+
+        if (!options.base_path.empty()) {
+            const profiler::ScopedPhase phase("load_base");
+            base_binary::LoadBase(options.base_path, catalogue);
+        }
+        if (options.input_path.empty()) {
+            json_reader.ParseInput(std::cin);
+        }
+        else {
+            json_reader.ParseFile(options.input_path);
+        }
+
+        {
+            // Ответы выводятся по мере вычисления, поэтому печать входит в этот этап
+            const profiler::ScopedPhase phase("stat_requests");
+            if (options.ndjson) {
+                json_reader.ProcessNdjsonRequests(std::cin, std::cout);
+            }
+            else {
+                json_reader.PrintOutput(std::cout);
+            }
+        }
+        if (options.stats) {
+            json_reader.PrintStats(std::cerr);
+        }
+        trace::Finish();
+        if (options.profile) {
+            profiler::PrintReport(std::cerr);
+        }
 
     }
     catch (const std::exception& e) {
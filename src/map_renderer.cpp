@@ -91,8 +91,8 @@ namespace map_renderer {
 			return sorted_buses;
 		}
 
-		std::map<std::string, geo::Coordinates> GetSortedUniqueStops(const std::set<const domain::Bus*, BusComparator>& sorted_buses) {
-			std::map<std::string, geo::Coordinates> unique_stops;
+		std::map<std::string_view, geo::Coordinates> GetSortedUniqueStops(const std::set<const domain::Bus*, BusComparator>& sorted_buses) {
+			std::map<std::string_view, geo::Coordinates> unique_stops;
 			for (const auto& bus : sorted_buses) {
 				for (const auto& stop : bus->bus_stops) {
 					unique_stops[stop->stop_name] = stop->position;
@@ -101,7 +101,7 @@ namespace map_renderer {
 			return unique_stops;
 		}
 
-		std::vector<geo::Coordinates> GetUniqueCoordinates(const std::map<std::string, geo::Coordinates>& unique_stops) {
+		std::vector<geo::Coordinates> GetUniqueCoordinates(const std::map<std::string_view, geo::Coordinates>& unique_stops) {
 			std::vector<geo::Coordinates> geo_coords;
 			geo_coords.reserve(unique_stops.size());
 			for (const auto& [stop_name, coordinates] : unique_stops) {
@@ -134,7 +134,7 @@ namespace map_renderer {
 					.SetStrokeLineCap(svg::StrokeLineCap::ROUND)
 					.SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
 
-				for (const auto* stop : bus->bus_stops) {
+				for (const auto* stop : bus->GetRoute()) {
 					polyline.AddPoint(projector(stop->position));
 				}
 
@@ -158,8 +158,7 @@ namespace map_renderer {
 				bus_names_coord.push_back(bus->bus_stops.front()->position);
 
 				if (!bus->is_circular) {
-					size_t stops_count = bus->bus_stops.size();
-					geo::Coordinates last = bus->bus_stops[stops_count / 2]->position;
+					geo::Coordinates last = bus->bus_stops.back()->position;
 					if (bus->bus_stops.front()->position != last) {
 						bus_names_coord.push_back(last);
 					}
@@ -173,7 +172,7 @@ namespace map_renderer {
 						.SetFontSize(render_settings.bus_label_font_size)
 						.SetFontFamily("Verdana")
 						.SetFontWeight("bold")
-						.SetData(bus->bus_name)
+						.SetData(std::string(bus->bus_name))
 						.SetFillColor(render_settings.underlayer_color)
 						.SetStrokeColor(render_settings.underlayer_color)
 						.SetStrokeWidth(render_settings.underlayer_width)
@@ -187,7 +186,7 @@ namespace map_renderer {
 						.SetFontSize(render_settings.bus_label_font_size)
 						.SetFontFamily("Verdana")
 						.SetFontWeight("bold")
-						.SetData(bus->bus_name)
+						.SetData(std::string(bus->bus_name))
 						.SetFillColor(render_settings.color_palette[color_index % render_settings.color_palette.size()])
 					);
 				}
@@ -197,7 +196,7 @@ namespace map_renderer {
 
 		void RenderStops(svg::Document& doc, const SphereProjector& projector,
 			const RenderSettings& render_settings,
-			const std::map<std::string, geo::Coordinates>& unique_stops) {
+			const std::map<std::string_view, geo::Coordinates>& unique_stops) {
 
 			for (const auto& [stop, position] : unique_stops) {
 				// Круги
@@ -211,7 +210,7 @@ namespace map_renderer {
 
 		void RenderStopNames(svg::Document& doc, const SphereProjector& projector,
 			const RenderSettings& render_settings,
-			const std::map<std::string, geo::Coordinates>& unique_stops) {
+			const std::map<std::string_view, geo::Coordinates>& unique_stops) {
 
 			for (const auto& [stop, position] : unique_stops) {
 				// Подложка
@@ -220,7 +219,7 @@ namespace map_renderer {
 					.SetOffset(render_settings.stop_label_offset)
 					.SetFontSize(render_settings.stop_label_font_size)
 					.SetFontFamily("Verdana")
-					.SetData(stop)
+					.SetData(std::string(stop))
 					.SetFillColor(render_settings.underlayer_color)
 					.SetStrokeColor(render_settings.underlayer_color)
 					.SetStrokeWidth(render_settings.underlayer_width)
@@ -233,7 +232,7 @@ namespace map_renderer {
 					.SetOffset(render_settings.stop_label_offset)
 					.SetFontSize(render_settings.stop_label_font_size)
 					.SetFontFamily("Verdana")
-					.SetData(stop)
+					.SetData(std::string(stop))
 					.SetFillColor("black")
 				);
 			}
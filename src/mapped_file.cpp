@@ -0,0 +1,76 @@
+#include "mapped_file.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+using namespace std::string_literals;
+
+namespace mapped_file {
+
+#ifdef _WIN32
+
+	MappedFile::MappedFile(const std::string& path) {
+		std::ifstream input(path, std::ios::binary);
+		if (!input) {
+			throw std::runtime_error("Cannot open file '"s + path + "'"s);
+		}
+		buffer_.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+		data_ = buffer_.data();
+		size_ = buffer_.size();
+	}
+
+	MappedFile::~MappedFile() = default;
+
+#else
+
+	MappedFile::MappedFile(const std::string& path) {
+		const int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			throw std::runtime_error("Cannot open file '"s + path + "': "s + std::strerror(errno));
+		}
+		struct stat file_stat {};
+		if (fstat(fd, &file_stat) != 0) {
+			const int error = errno;
+			close(fd);
+			throw std::runtime_error("Cannot stat file '"s + path + "': "s + std::strerror(error));
+		}
+		size_ = static_cast<size_t>(file_stat.st_size);
+		// Пустой файл отобразить нельзя, для него достаточно пустого представления
+		if (size_ > 0) {
+			void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data == MAP_FAILED) {
+				const int error = errno;
+				close(fd);
+				throw std::runtime_error("Cannot map file '"s + path + "': "s + std::strerror(error));
+			}
+			// Файл читается один раз от начала до конца
+			madvise(data, size_, MADV_SEQUENTIAL);
+			data_ = static_cast<const char*>(data);
+		}
+		close(fd);
+	}
+
+	MappedFile::~MappedFile() {
+		if (data_) {
+			munmap(const_cast<char*>(data_), size_);
+		}
+	}
+
+#endif
+
+	std::string_view MappedFile::GetData() const {
+		return { data_, size_ };
+	}
+
+} // namespace mapped_file
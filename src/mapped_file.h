@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace mapped_file {
+
+	// Файл, отображённый в память только для чтения. Содержимое доступно
+	// как std::string_view и остаётся валидным, пока жив объект.
+	// Там, где отображение недоступно, файл целиком считывается в память
+	class MappedFile {
+	public:
+		explicit MappedFile(const std::string& path);
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		~MappedFile();
+
+		std::string_view GetData() const;
+
+	private:
+		const char* data_ = nullptr;
+		size_t size_ = 0;
+#ifdef _WIN32
+		std::string buffer_;
+#endif
+	};
+
+} // namespace mapped_file
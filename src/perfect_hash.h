@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace perfect_hash {
+
+	// Минимальная совершенная хеш-таблица над фиксированным набором строковых ключей
+	// (схема hash-and-displace). Каждому ключу соответствует ровно одна ячейка плоского
+	// массива, поэтому поиск — это одно вычисление хеша и одно сравнение строк.
+	// Ключи должны быть уникальны и жить дольше таблицы
+	template <typename Value>
+	class PerfectHashMap {
+	public:
+		using Item = std::pair<std::string_view, Value>;
+
+		PerfectHashMap() = default;
+		explicit PerfectHashMap(std::vector<Item> items);
+
+		const Value* Find(std::string_view key) const;
+		size_t Size() const;
+
+	private:
+		static constexpr uint32_t MAX_SEED = 1u << 20;
+		static constexpr size_t ITEMS_PER_BUCKET = 4;
+
+		static size_t Slot(size_t hash, uint32_t seed, size_t size);
+		bool TryBuild(std::vector<Item>& items, const std::vector<size_t>& hashes, size_t buckets_count);
+
+		std::vector<uint32_t> seeds_; // смещение для каждой корзины
+		std::vector<Item> slots_;
+	};
+
+	template <typename Value>
+	PerfectHashMap<Value>::PerfectHashMap(std::vector<Item> items) {
+		if (items.empty()) {
+			return;
+		}
+		std::vector<size_t> hashes;
+		hashes.reserve(items.size());
+		for (const auto& [key, value] : items) {
+			hashes.push_back(std::hash<std::string_view>{}(key));
+		}
+
+		// При неудаче увеличиваем число корзин: чем меньше корзины, тем проще их разместить
+		for (size_t buckets_count = items.size() / ITEMS_PER_BUCKET + 1;
+			buckets_count <= items.size() * 2; buckets_count *= 2) {
+			if (TryBuild(items, hashes, buckets_count)) {
+				return;
+			}
+		}
+		throw std::runtime_error("Failed to build perfect hash: duplicate keys");
+	}
+
+	template <typename Value>
+	const Value* PerfectHashMap<Value>::Find(std::string_view key) const {
+		if (slots_.empty()) {
+			return nullptr;
+		}
+		const size_t hash = std::hash<std::string_view>{}(key);
+		const Item& item = slots_[Slot(hash, seeds_[hash % seeds_.size()], slots_.size())];
+		return item.first == key ? &item.second : nullptr;
+	}
+
+	template <typename Value>
+	size_t PerfectHashMap<Value>::Size() const {
+		return slots_.size();
+	}
+
+	template <typename Value>
+	size_t PerfectHashMap<Value>::Slot(size_t hash, uint32_t seed, size_t size) {
+		// Перемешивание splitmix64
+		uint64_t x = static_cast<uint64_t>(hash) ^ (static_cast<uint64_t>(seed) * 0x9E3779B97F4A7C15ull);
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+		x ^= x >> 31;
+		return static_cast<size_t>(x % size);
+	}
+
+	template <typename Value>
+	bool PerfectHashMap<Value>::TryBuild(std::vector<Item>& items, const std::vector<size_t>& hashes,
+		size_t buckets_count) {
+		const size_t size = items.size();
+
+		// Ключи, сгруппированные по корзинам: bucket_items[bucket_offsets[b]..bucket_offsets[b + 1])
+		std::vector<size_t> bucket_offsets(buckets_count + 1, 0);
+		for (size_t hash : hashes) {
+			++bucket_offsets[hash % buckets_count + 1];
+		}
+		std::partial_sum(bucket_offsets.begin(), bucket_offsets.end(), bucket_offsets.begin());
+		std::vector<size_t> bucket_items(size);
+		std::vector<size_t> positions(bucket_offsets.begin(), bucket_offsets.end() - 1);
+		for (size_t i = 0; i < size; ++i) {
+			bucket_items[positions[hashes[i] % buckets_count]++] = i;
+		}
+
+		// Крупные корзины размещаются первыми, пока свободных ячеек много
+		std::vector<size_t> buckets_order(buckets_count);
+		std::iota(buckets_order.begin(), buckets_order.end(), 0);
+		std::stable_sort(buckets_order.begin(), buckets_order.end(), [&bucket_offsets](size_t lhs, size_t rhs) {
+			return bucket_offsets[lhs + 1] - bucket_offsets[lhs] > bucket_offsets[rhs + 1] - bucket_offsets[rhs];
+			});
+
+		std::vector<uint32_t> seeds(buckets_count, 0);
+		std::vector<size_t> item_slots(size);
+		std::vector<bool> taken(size, false);
+		std::vector<size_t> candidate_slots;
+
+		for (size_t bucket : buckets_order) {
+			const size_t begin = bucket_offsets[bucket];
+			const size_t end = bucket_offsets[bucket + 1];
+			if (begin == end) {
+				break;
+			}
+
+			bool placed = false;
+			for (uint32_t seed = 0; seed < MAX_SEED && !placed; ++seed) {
+				candidate_slots.clear();
+				placed = true;
+				for (size_t i = begin; i < end; ++i) {
+					const size_t slot = Slot(hashes[bucket_items[i]], seed, size);
+					if (taken[slot] || std::find(candidate_slots.begin(), candidate_slots.end(), slot) != candidate_slots.end()) {
+						placed = false;
+						break;
+					}
+					candidate_slots.push_back(slot);
+				}
+				if (placed) {
+					seeds[bucket] = seed;
+					for (size_t i = begin; i < end; ++i) {
+						item_slots[bucket_items[i]] = candidate_slots[i - begin];
+						taken[candidate_slots[i - begin]] = true;
+					}
+				}
+			}
+			if (!placed) {
+				return false;
+			}
+		}
+
+		seeds_ = std::move(seeds);
+		slots_.resize(size);
+		for (size_t i = 0; i < size; ++i) {
+			slots_[item_slots[i]] = std::move(items[i]);
+		}
+		return true;
+	}
+
+} // namespace perfect_hash
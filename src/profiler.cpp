@@ -0,0 +1,188 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <ctime>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "json_writer.h"
+
+namespace profiler {
+
+	namespace {
+
+		struct PhaseRecord {
+			std::string_view name;
+			int depth;
+			std::chrono::steady_clock::time_point start;
+			std::chrono::nanoseconds wall_time;
+			std::chrono::microseconds cpu_time;
+			uint64_t allocations;
+			uint64_t allocated_bytes;
+			long max_rss_kb;
+		};
+
+		std::atomic<bool> enabled{ false };
+		std::mutex records_mutex;
+		std::vector<PhaseRecord> records;
+		thread_local int current_depth = 0;
+
+		std::atomic<uint64_t> allocations_count{ 0 };
+		std::atomic<uint64_t> allocated_bytes{ 0 };
+
+		std::chrono::microseconds GetCpuTime() {
+#ifdef _WIN32
+			return std::chrono::microseconds(std::clock() * 1'000'000 / CLOCKS_PER_SEC);
+#else
+			rusage usage{};
+			getrusage(RUSAGE_SELF, &usage);
+			const auto to_microseconds = [](const timeval& time) {
+				return std::chrono::seconds(time.tv_sec) + std::chrono::microseconds(time.tv_usec);
+			};
+			return to_microseconds(usage.ru_utime) + to_microseconds(usage.ru_stime);
+#endif
+		}
+
+		// Пик резидентной памяти процесса с начала работы, КиБ
+		long GetMaxRssKb() {
+#ifdef _WIN32
+			return 0;
+#else
+			rusage usage{};
+			getrusage(RUSAGE_SELF, &usage);
+			return usage.ru_maxrss;
+#endif
+		}
+
+	} // namespace
+
+	void Enable() {
+		enabled.store(true, std::memory_order_relaxed);
+	}
+
+	bool IsEnabled() {
+		return enabled.load(std::memory_order_relaxed);
+	}
+
+	bool IsCountingAllocations() {
+#ifdef TC_COUNT_ALLOCATIONS
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	// ===== class ScopedPhase =====
+
+	ScopedPhase::ScopedPhase(std::string_view name)
+		: span_(name, "phase")
+		, name_(name)
+		, enabled_(IsEnabled()) {
+		if (!enabled_) {
+			return;
+		}
+		depth_ = current_depth++;
+		allocations_start_ = allocations_count.load(std::memory_order_relaxed);
+		allocated_bytes_start_ = allocated_bytes.load(std::memory_order_relaxed);
+		cpu_start_ = GetCpuTime();
+		wall_start_ = std::chrono::steady_clock::now();
+	}
+
+	ScopedPhase::~ScopedPhase() {
+		if (!enabled_) {
+			return;
+		}
+		const auto wall_end = std::chrono::steady_clock::now();
+		const auto cpu_end = GetCpuTime();
+		--current_depth;
+
+		PhaseRecord record{
+			name_,
+			depth_,
+			wall_start_,
+			wall_end - wall_start_,
+			cpu_end - cpu_start_,
+			allocations_count.load(std::memory_order_relaxed) - allocations_start_,
+			allocated_bytes.load(std::memory_order_relaxed) - allocated_bytes_start_,
+			GetMaxRssKb()
+		};
+		std::lock_guard lock(records_mutex);
+		records.push_back(record);
+	}
+
+	void PrintReport(std::ostream& output) {
+		std::vector<PhaseRecord> sorted_records;
+		{
+			std::lock_guard lock(records_mutex);
+			sorted_records = records;
+		}
+		std::stable_sort(sorted_records.begin(), sorted_records.end(),
+			[](const PhaseRecord& lhs, const PhaseRecord& rhs) {
+				return lhs.start < rhs.start;
+			});
+
+		const auto milliseconds = [](auto duration) {
+			return std::chrono::duration<double, std::milli>(duration).count();
+		};
+		// Значения, не помещающиеся в int json::Node, выводятся как double
+		const auto count = [](uint64_t value) -> json::Node::Value {
+			if (value <= static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+				return static_cast<int>(value);
+			}
+			return static_cast<double>(value);
+		};
+
+		json::Writer writer(output, json::NumberFormat::SHORTEST);
+		auto phases_context = writer.StartDict().Key("phases").StartArray();
+		for (const PhaseRecord& record : sorted_records) {
+			auto phase_context = phases_context.StartDict();
+			if (IsCountingAllocations()) {
+				phase_context.Key("allocated_bytes").Value(count(record.allocated_bytes))
+					.Key("allocations").Value(count(record.allocations));
+			}
+			phase_context.Key("cpu_ms").Value(milliseconds(record.cpu_time))
+				.Key("depth").Value(record.depth)
+				.Key("max_rss_kb").Value(count(static_cast<uint64_t>(record.max_rss_kb)))
+				.Key("name").Value(record.name)
+				.Key("wall_ms").Value(milliseconds(record.wall_time))
+				.EndDict();
+		}
+		phases_context.EndArray().EndDict();
+		writer.Finish();
+		output << std::endl;
+	}
+
+} // namespace profiler
+
+#ifdef TC_COUNT_ALLOCATIONS
+
+// Считающий глобальный распределитель памяти. Массивы и nothrow-версии
+// по умолчанию выделяют память через эти функции
+void* operator new(std::size_t size) {
+	profiler::allocations_count.fetch_add(1, std::memory_order_relaxed);
+	profiler::allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+	if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+#endif
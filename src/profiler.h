@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+#include "trace.h"
+
+namespace profiler {
+
+	// Профилирование этапов работы программы. Пока профилирование не включено,
+	// ScopedPhase ограничивается проверкой флага.
+	// Счётчики выделений памяти доступны, если программа собрана с TC_COUNT_ALLOCATIONS:
+	// тогда подключается считающий глобальный operator new
+	void Enable();
+	bool IsEnabled();
+	bool IsCountingAllocations();
+
+	// Замеряет этап от создания до выхода из области видимости: время по часам,
+	// процессорное время процесса, число и объём выделений памяти и пик резидентной памяти.
+	// Вложенные этапы входят в объемлющие, выделения памяти считаются по всем потокам.
+	// При записи трассы этап попадает в неё независимо от профилирования
+	class ScopedPhase {
+	public:
+		// name должен жить до вывода отчёта, обычно это строковый литерал
+		explicit ScopedPhase(std::string_view name);
+		ScopedPhase(const ScopedPhase&) = delete;
+		ScopedPhase& operator=(const ScopedPhase&) = delete;
+		~ScopedPhase();
+
+	private:
+		trace::ScopedSpan span_;
+		std::string_view name_;
+		bool enabled_;
+		int depth_ = 0;
+		std::chrono::steady_clock::time_point wall_start_;
+		std::chrono::microseconds cpu_start_{};
+		uint64_t allocations_start_ = 0;
+		uint64_t allocated_bytes_start_ = 0;
+	};
+
+	// Выводит завершённые этапы в порядке их начала в формате JSON
+	void PrintReport(std::ostream& output);
+
+} // namespace profiler
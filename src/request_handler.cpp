@@ -14,12 +14,22 @@ namespace request_handler {
 		return db_.GetBusInfo(bus_name);
 	}
 
-	const std::set<std::string_view>* RequestHandler::GetBusesByStop(const std::string_view& stop_name) const {
+	std::optional<BusesRange> RequestHandler::GetBusesByStop(const std::string_view& stop_name) const {
 		const auto* stop = db_.FindStop(stop_name);
 		if (!stop) {
-			return nullptr;
+			return std::nullopt;
+		}
+		return db_.GetBusesForStop(stop);
+	}
+
+	std::optional<std::vector<std::string_view>> RequestHandler::GetCommonBuses(const std::string_view& stop_name_1,
+		const std::string_view& stop_name_2) const {
+		const auto* stop_1 = db_.FindStop(stop_name_1);
+		const auto* stop_2 = db_.FindStop(stop_name_2);
+		if (!stop_1 || !stop_2) {
+			return std::nullopt;
 		}
-		return &db_.GetBusesForStop(stop);
+		return db_.GetCommonBuses(stop_1, stop_2);
 	}
 
 	svg::Document RequestHandler::RenderMap() const {
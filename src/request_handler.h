@@ -12,7 +12,9 @@ namespace request_handler {
 	public:
 		RequestHandler(const TransportCatalogue& db, const map_renderer::MapRenderer& renderer);
 		std::optional<domain::BusInfo> GetBusStat(const std::string_view& bus_name) const;
-		const std::set<std::string_view>* GetBusesByStop(const std::string_view& stop_name) const;
+		std::optional<BusesRange> GetBusesByStop(const std::string_view& stop_name) const;
+		std::optional<std::vector<std::string_view>> GetCommonBuses(const std::string_view& stop_name_1,
+			const std::string_view& stop_name_2) const;
 		svg::Document RenderMap() const;
 
 	private:
@@ -0,0 +1,156 @@
+#include "request_stats.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std::literals;
+
+namespace request_stats {
+
+	// ===== class LatencyHistogram =====
+
+	void LatencyHistogram::Record(uint64_t value) {
+		++buckets_[GetBucketIndex(value)];
+		++count_;
+		max_ = std::max(max_, value);
+	}
+
+	void LatencyHistogram::Merge(const LatencyHistogram& other) {
+		for (size_t i = 0; i < BUCKETS_COUNT; ++i) {
+			buckets_[i] += other.buckets_[i];
+		}
+		count_ += other.count_;
+		max_ = std::max(max_, other.max_);
+	}
+
+	uint64_t LatencyHistogram::GetCount() const {
+		return count_;
+	}
+
+	uint64_t LatencyHistogram::GetMax() const {
+		return max_;
+	}
+
+	uint64_t LatencyHistogram::GetPercentile(double quantile) const {
+		if (count_ == 0) {
+			return 0;
+		}
+		const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(quantile * static_cast<double>(count_))));
+		uint64_t seen = 0;
+		for (size_t i = 0; i < BUCKETS_COUNT; ++i) {
+			seen += buckets_[i];
+			if (seen >= rank) {
+				return std::min(GetBucketUpperBound(i), max_);
+			}
+		}
+		return max_;
+	}
+
+	// Значения меньше SUB_BUCKETS_COUNT попадают в отдельные корзины, остальные -
+	// в корзину по старшему биту и следующим за ним SUB_BUCKET_BITS битам
+	size_t LatencyHistogram::GetBucketIndex(uint64_t value) {
+		if (value < SUB_BUCKETS_COUNT) {
+			return static_cast<size_t>(value);
+		}
+#if defined(__GNUC__) || defined(__clang__)
+		const int exponent = 63 - __builtin_clzll(value);
+#else
+		int exponent = 0;
+		while (value >> (exponent + 1)) {
+			++exponent;
+		}
+#endif
+		const uint64_t sub_bucket = (value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS_COUNT - 1);
+		return static_cast<size_t>((exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS_COUNT + sub_bucket);
+	}
+
+	uint64_t LatencyHistogram::GetBucketUpperBound(size_t index) {
+		if (index < SUB_BUCKETS_COUNT) {
+			return index;
+		}
+		const int shift = static_cast<int>(index / SUB_BUCKETS_COUNT) - 1;
+		const uint64_t sub_bucket = index % SUB_BUCKETS_COUNT;
+		return ((SUB_BUCKETS_COUNT + sub_bucket + 1) << shift) - 1;
+	}
+
+	// ===== RequestType =====
+
+	RequestType GetRequestType(std::string_view type) {
+		if (type == "Bus"sv) {
+			return RequestType::BUS;
+		}
+		if (type == "Stop"sv) {
+			return RequestType::STOP;
+		}
+		if (type == "Route"sv) {
+			return RequestType::ROUTE;
+		}
+		if (type == "Map"sv) {
+			return RequestType::MAP;
+		}
+		return RequestType::OTHER;
+	}
+
+	std::string_view GetRequestTypeName(RequestType type) {
+		switch (type) {
+		case RequestType::BUS:
+			return "Bus"sv;
+		case RequestType::STOP:
+			return "Stop"sv;
+		case RequestType::ROUTE:
+			return "Route"sv;
+		case RequestType::MAP:
+			return "Map"sv;
+		default:
+			return "Other"sv;
+		}
+	}
+
+	// ===== class RequestStats =====
+
+	void RequestStats::RecordLatency(RequestType type, std::chrono::nanoseconds latency) {
+		latencies_[static_cast<size_t>(type)].Record(static_cast<uint64_t>(std::max<int64_t>(0, latency.count())));
+	}
+
+	void RequestStats::RecordRouteEdges(size_t edges_count) {
+		++routes_found_;
+		route_edges_ += edges_count;
+	}
+
+	void RequestStats::Merge(const RequestStats& other) {
+		for (size_t i = 0; i < REQUEST_TYPES_COUNT; ++i) {
+			latencies_[i].Merge(other.latencies_[i]);
+		}
+		routes_found_ += other.routes_found_;
+		route_edges_ += other.route_edges_;
+	}
+
+	const LatencyHistogram& RequestStats::GetLatency(RequestType type) const {
+		return latencies_[static_cast<size_t>(type)];
+	}
+
+	uint64_t RequestStats::GetRoutesFound() const {
+		return routes_found_;
+	}
+
+	uint64_t RequestStats::GetRouteEdges() const {
+		return route_edges_;
+	}
+
+	// ===== class ScopedLatency =====
+
+	ScopedLatency::ScopedLatency(RequestStats* stats, std::string_view type)
+		: stats_(stats) {
+		if (stats_) {
+			type_ = GetRequestType(type);
+			start_ = Clock::now();
+		}
+	}
+
+	ScopedLatency::~ScopedLatency() {
+		if (stats_) {
+			stats_->RecordLatency(type_, Clock::now() - start_);
+		}
+	}
+
+} // namespace request_stats
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+namespace request_stats {
+
+	// Гистограмма задержек в наносекундах с лог-линейными корзинами:
+	// каждая степень двойки делится на SUB_BUCKETS_COUNT равных частей,
+	// поэтому относительная погрешность перцентилей не превышает 1/SUB_BUCKETS_COUNT
+	class LatencyHistogram {
+	public:
+		void Record(uint64_t value);
+		void Merge(const LatencyHistogram& other);
+
+		uint64_t GetCount() const;
+		uint64_t GetMax() const;
+		// Верхняя граница корзины, в которую попадает доля quantile значений
+		uint64_t GetPercentile(double quantile) const;
+
+	private:
+		static constexpr int SUB_BUCKET_BITS = 4;
+		static constexpr uint64_t SUB_BUCKETS_COUNT = 1 << SUB_BUCKET_BITS;
+		static constexpr size_t BUCKETS_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS_COUNT;
+
+		static size_t GetBucketIndex(uint64_t value);
+		static uint64_t GetBucketUpperBound(size_t index);
+
+		std::array<uint64_t, BUCKETS_COUNT> buckets_{};
+		uint64_t count_ = 0;
+		uint64_t max_ = 0;
+	};
+
+	enum class RequestType { BUS, STOP, ROUTE, MAP, OTHER };
+	constexpr size_t REQUEST_TYPES_COUNT = 5;
+
+	RequestType GetRequestType(std::string_view type);
+	std::string_view GetRequestTypeName(RequestType type);
+
+	// Статистика ответов на запросы. Каждый поток ведёт собственный экземпляр
+	// без блокировок, экземпляры объединяются после обработки пакета
+	class RequestStats {
+	public:
+		void RecordLatency(RequestType type, std::chrono::nanoseconds latency);
+		// Число рёбер графа в найденном маршруте
+		void RecordRouteEdges(size_t edges_count);
+		void Merge(const RequestStats& other);
+
+		const LatencyHistogram& GetLatency(RequestType type) const;
+		uint64_t GetRoutesFound() const;
+		uint64_t GetRouteEdges() const;
+
+	private:
+		std::array<LatencyHistogram, REQUEST_TYPES_COUNT> latencies_;
+		uint64_t routes_found_ = 0;
+		uint64_t route_edges_ = 0;
+	};
+
+	// Замеряет время ответа на запрос и записывает его при выходе из области видимости.
+	// При stats == nullptr ничего не делает
+	class ScopedLatency {
+	public:
+		ScopedLatency(RequestStats* stats, std::string_view type);
+		ScopedLatency(const ScopedLatency&) = delete;
+		ScopedLatency& operator=(const ScopedLatency&) = delete;
+		~ScopedLatency();
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		RequestStats* stats_;
+		RequestType type_ = RequestType::OTHER;
+		Clock::time_point start_;
+	};
+
+} // namespace request_stats
@@ -0,0 +1,82 @@
+#include "response_cache.h"
+
+#include <functional>
+
+namespace response_cache {
+
+	ResponseCache::ResponseCache(size_t capacity)
+		: shard_capacity_((capacity + SHARDS_COUNT - 1) / SHARDS_COUNT) {
+		shards_.reserve(SHARDS_COUNT);
+		for (size_t i = 0; i < SHARDS_COUNT; ++i) {
+			shards_.push_back(std::make_unique<Shard>());
+		}
+	}
+
+	bool ResponseCache::IsEnabled() const {
+		return shard_capacity_ > 0;
+	}
+
+	std::shared_ptr<const CachedResponse> ResponseCache::Find(std::string_view key, uint64_t version) {
+		Shard& shard = GetShard(key);
+		std::lock_guard lock(shard.mutex);
+		SyncVersion(shard, version);
+
+		auto it = shard.index.find(key);
+		if (it == shard.index.end()) {
+			misses_.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		hits_.fetch_add(1, std::memory_order_relaxed);
+		shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+		return it->second->response;
+	}
+
+	void ResponseCache::Insert(std::string key, uint64_t version, CachedResponse response) {
+		if (!IsEnabled()) {
+			return;
+		}
+		Shard& shard = GetShard(key);
+		std::lock_guard lock(shard.mutex);
+		SyncVersion(shard, version);
+
+		if (shard.index.count(key)) {
+			return;
+		}
+		if (shard.entries.size() == shard_capacity_) {
+			shard.index.erase(shard.entries.back().key);
+			shard.entries.pop_back();
+		}
+		shard.entries.push_front({ std::move(key), std::make_shared<const CachedResponse>(std::move(response)) });
+		shard.index.emplace(shard.entries.front().key, shard.entries.begin());
+	}
+
+	void ResponseCache::Clear() {
+		for (auto& shard : shards_) {
+			std::lock_guard lock(shard->mutex);
+			shard->index.clear();
+			shard->entries.clear();
+		}
+	}
+
+	uint64_t ResponseCache::GetHits() const {
+		return hits_.load(std::memory_order_relaxed);
+	}
+
+	uint64_t ResponseCache::GetMisses() const {
+		return misses_.load(std::memory_order_relaxed);
+	}
+
+	ResponseCache::Shard& ResponseCache::GetShard(std::string_view key) {
+		return *shards_[std::hash<std::string_view>{}(key) % SHARDS_COUNT];
+	}
+
+	// Записи другой версии справочника устарели целиком
+	void ResponseCache::SyncVersion(Shard& shard, uint64_t version) {
+		if (shard.version != version) {
+			shard.index.clear();
+			shard.entries.clear();
+			shard.version = version;
+		}
+	}
+
+} // namespace response_cache
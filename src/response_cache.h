@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace response_cache {
+
+	// Сериализованный ответ без значения request_id, которое вставляется в позицию id_offset
+	struct CachedResponse {
+		std::string text;
+		size_t id_offset = 0;
+		std::optional<size_t> route_edges; // число рёбер маршрута в ответе Route, для статистики
+	};
+
+	// Ограниченный кеш ответов, вытесняющий давно не использованные записи (LRU).
+	// Ключи распределены по независимым сегментам со своими блокировками, поэтому
+	// потоки, обращающиеся к разным ключам, почти не мешают друг другу.
+	// Записи действительны только для той версии справочника, с которой были добавлены
+	class ResponseCache {
+	public:
+		// capacity - общее число записей, 0 отключает кеш
+		explicit ResponseCache(size_t capacity = 0);
+
+		bool IsEnabled() const;
+		std::shared_ptr<const CachedResponse> Find(std::string_view key, uint64_t version);
+		void Insert(std::string key, uint64_t version, CachedResponse response);
+		void Clear();
+
+		uint64_t GetHits() const;
+		uint64_t GetMisses() const;
+
+	private:
+		static constexpr size_t SHARDS_COUNT = 16;
+
+		struct Entry {
+			std::string key;
+			std::shared_ptr<const CachedResponse> response;
+		};
+
+		struct Shard {
+			std::mutex mutex;
+			uint64_t version = 0;
+			std::list<Entry> entries; // от недавно использованных к давно использованным
+			std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+		};
+
+		Shard& GetShard(std::string_view key);
+		// Вызывается под блокировкой сегмента
+		static void SyncVersion(Shard& shard, uint64_t version);
+
+		size_t shard_capacity_ = 0;
+		std::vector<std::unique_ptr<Shard>> shards_;
+		std::atomic<uint64_t> hits_{ 0 };
+		std::atomic<uint64_t> misses_{ 0 };
+	};
+
+} // namespace response_cache
@@ -28,6 +28,14 @@ public:
     };
 
     std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    // on_edge() вызывается для каждого ребра восстанавливаемого маршрута и может прервать восстановление исключением
+    template <typename OnEdge>
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to, OnEdge on_edge) const;
+
+    // Число попыток улучшить маршрут при предварительном расчёте
+    uint64_t GetRelaxationsCount() const {
+        return relaxations_count_;
+    }
 
 private:
     struct RouteInternalData {
@@ -68,6 +76,7 @@ private:
             if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
                 for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
                     if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
+                        ++relaxations_count_;
                         RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
                     }
                 }
@@ -78,6 +87,7 @@ private:
     static constexpr Weight ZERO_WEIGHT{};
     const Graph& graph_;
     RoutesInternalData routes_internal_data_;
+    uint64_t relaxations_count_ = 0;
 };
 
 template <typename Weight>
@@ -97,6 +107,14 @@ Router<Weight>::Router(const Graph& graph)
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
                                                                              VertexId to) const {
+    return BuildRoute(from, to, [] {});
+}
+
+template <typename Weight>
+template <typename OnEdge>
+std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
+                                                                             VertexId to,
+                                                                             OnEdge on_edge) const {
     const auto& route_internal_data = routes_internal_data_.at(from).at(to);
     if (!route_internal_data) {
         return std::nullopt;
@@ -107,6 +125,7 @@ std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(Ver
          edge_id;
          edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
     {
+        on_edge();
         edges.push_back(*edge_id);
     }
     std::reverse(edges.begin(), edges.end());
@@ -0,0 +1,372 @@
+#include "server.h"
+
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "base_binary.h"
+#include "json_arena.h"
+#include "json_reader.h"
+#include "json_writer.h"
+#include "transport_catalogue.h"
+
+using namespace std::literals;
+
+namespace server {
+
+	namespace {
+
+		std::ifstream OpenFile(const std::string& path, std::ios::openmode mode = std::ios::in) {
+			std::ifstream file(path, mode);
+			if (!file) {
+				throw std::runtime_error("Cannot open file '"s + path + "'"s);
+			}
+			return file;
+		}
+
+	} // namespace
+
+	struct Server::Snapshot {
+		transport_catalogue::TransportCatalogue catalogue;
+		transport_catalogue::JsonReader reader{ catalogue };
+	};
+
+	// ===== class Server::Workers =====
+
+	Server::Workers::Workers(size_t threads_count) {
+		if (threads_count == 0) {
+			threads_count = std::max(1u, std::thread::hardware_concurrency());
+		}
+		for (size_t i = 0; i < threads_count; ++i) {
+			threads_.emplace_back([this] { WorkerLoop(); });
+		}
+	}
+
+	Server::Workers::~Workers() {
+		{
+			std::lock_guard lock(mutex_);
+			stopping_ = true;
+		}
+		cv_.notify_all();
+		for (auto& thread : threads_) {
+			thread.join();
+		}
+	}
+
+	void Server::Workers::Push(std::function<void()> task) {
+		{
+			std::lock_guard lock(mutex_);
+			tasks_.push_back(std::move(task));
+		}
+		cv_.notify_one();
+	}
+
+	void Server::Workers::WorkerLoop() {
+		while (true) {
+			std::function<void()> task;
+			{
+				std::unique_lock lock(mutex_);
+				cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+				if (tasks_.empty()) {
+					return;
+				}
+				task = std::move(tasks_.front());
+				tasks_.pop_front();
+			}
+			task();
+		}
+	}
+
+	// ===== class Server =====
+
+	Server::Server(Settings settings)
+		: settings_(std::move(settings))
+		, snapshot_(LoadSnapshot()) {
+	}
+
+	// Каждый документ обрабатывается одним потоком пула, поэтому справочнику
+	// собственные потоки не нужны
+	std::shared_ptr<const Server::Snapshot> Server::LoadSnapshot() const {
+		auto snapshot = std::make_shared<Snapshot>();
+		snapshot->reader.SetThreadsCount(1);
+		snapshot->reader.SetCacheCapacity(settings_.cache_capacity);
+		snapshot->reader.SetRequestTimeout(settings_.request_timeout);
+		snapshot->reader.SetBatchTimeout(settings_.batch_timeout);
+		// Файлы читаются в память снимка, а не отображаются: снимок живёт долго,
+		// и запись в файл на месте не должна ломать обработку запросов
+		if (!settings_.base_path.empty()) {
+			std::ifstream base = OpenFile(settings_.base_path, std::ios::binary);
+			base_binary::LoadBase(base, snapshot->catalogue);
+		}
+		std::ifstream input = OpenFile(settings_.input_path);
+		snapshot->reader.ParseInput(input);
+		return snapshot;
+	}
+
+	void Server::Reload() {
+		std::lock_guard lock(reload_mutex_);
+		std::atomic_store(&snapshot_, LoadSnapshot());
+	}
+
+	std::string Server::ProcessDocument(const std::string& input) {
+		std::ostringstream output;
+		try {
+			const json::arena::Document document = json::arena::Load(input);
+			const json::arena::Object root = document.GetRoot().AsMap();
+			if (const json::arena::Value* command = root.Find("command")) {
+				if (command->AsString() != "reload"sv) {
+					throw std::invalid_argument("Unknown command: "s + std::string(command->AsString()));
+				}
+				Reload();
+				json::Writer writer(output);
+				writer.StartDict().Key("status").Value("ok"s).EndDict();
+				writer.Finish();
+			}
+			else {
+				const auto snapshot = std::atomic_load(&snapshot_);
+				snapshot->reader.PrintResponses(root.at("stat_requests").AsArray(), output);
+			}
+		}
+		catch (const std::exception& e) {
+			output.str({});
+			json::Writer writer(output);
+			writer.StartDict().Key("error_message").Value(e.what()).EndDict();
+			writer.Finish();
+		}
+		output.put('\n');
+		return output.str();
+	}
+
+#ifdef _WIN32
+
+	Server::~Server() = default;
+
+	void Server::Run() {
+		throw std::runtime_error("Unix domain sockets are not supported on this platform"s);
+	}
+
+#else
+
+	namespace {
+
+		volatile std::sig_atomic_t stop_requested = 0;
+		int signal_wake_fd = -1;
+
+		void HandleStopSignal(int) {
+			stop_requested = 1;
+			if (signal_wake_fd >= 0) {
+				[[maybe_unused]] const ssize_t result = write(signal_wake_fd, "s", 1);
+			}
+		}
+
+		std::runtime_error MakeSystemError(const std::string& what) {
+			return std::runtime_error(what + ": "s + std::strerror(errno));
+		}
+
+		void SetNonBlocking(int fd) {
+			const int flags = fcntl(fd, F_GETFL, 0);
+			if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+				throw MakeSystemError("Cannot make descriptor non-blocking"s);
+			}
+		}
+
+	} // namespace
+
+	Server::~Server() {
+		for (const auto& [fd, connection] : connections_) {
+			close(fd);
+		}
+		if (listen_fd_ >= 0) {
+			close(listen_fd_);
+			unlink(settings_.socket_path.c_str());
+		}
+		signal_wake_fd = -1;
+		for (int fd : wake_pipe_) {
+			if (fd >= 0) {
+				close(fd);
+			}
+		}
+	}
+
+	void Server::OpenSocket() {
+		sockaddr_un address{};
+		address.sun_family = AF_UNIX;
+		if (settings_.socket_path.size() >= sizeof(address.sun_path)) {
+			throw std::invalid_argument("Socket path is too long: "s + settings_.socket_path);
+		}
+		std::memcpy(address.sun_path, settings_.socket_path.c_str(), settings_.socket_path.size() + 1);
+
+		listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (listen_fd_ < 0) {
+			throw MakeSystemError("Cannot create socket"s);
+		}
+		// Файл сокета мог остаться от предыдущего запуска
+		unlink(settings_.socket_path.c_str());
+		if (bind(listen_fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0
+			|| listen(listen_fd_, SOMAXCONN) < 0) {
+			throw MakeSystemError("Cannot listen on '"s + settings_.socket_path + "'"s);
+		}
+		SetNonBlocking(listen_fd_);
+
+		if (pipe(wake_pipe_) < 0) {
+			throw MakeSystemError("Cannot create pipe"s);
+		}
+		SetNonBlocking(wake_pipe_[0]);
+		SetNonBlocking(wake_pipe_[1]);
+	}
+
+	void Server::Run() {
+		OpenSocket();
+
+		signal_wake_fd = wake_pipe_[1];
+		stop_requested = 0;
+		std::signal(SIGINT, HandleStopSignal);
+		std::signal(SIGTERM, HandleStopSignal);
+		std::signal(SIGPIPE, SIG_IGN);
+
+		Workers workers(settings_.threads_count);
+		std::vector<pollfd> poll_fds;
+		while (!stop_requested) {
+			poll_fds.clear();
+			poll_fds.push_back({ listen_fd_, POLLIN, 0 });
+			poll_fds.push_back({ wake_pipe_[0], POLLIN, 0 });
+			for (const auto& [fd, connection] : connections_) {
+				if (connection.state == Connection::State::READING) {
+					poll_fds.push_back({ fd, POLLIN, 0 });
+				}
+				else if (connection.state == Connection::State::WRITING) {
+					poll_fds.push_back({ fd, POLLOUT, 0 });
+				}
+			}
+
+			if (poll(poll_fds.data(), poll_fds.size(), -1) < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				throw MakeSystemError("poll failed"s);
+			}
+
+			if (poll_fds[1].revents) {
+				TakeCompletedResponses();
+			}
+			if (poll_fds[0].revents & POLLIN) {
+				AcceptConnections();
+			}
+			for (size_t i = 2; i < poll_fds.size(); ++i) {
+				if (!poll_fds[i].revents) {
+					continue;
+				}
+				const int fd = poll_fds[i].fd;
+				Connection& connection = connections_.at(fd);
+				const bool keep = connection.state == Connection::State::READING
+					? ReadInput(fd, connection)
+					: WriteOutput(fd, connection);
+				if (!keep) {
+					close(fd);
+					connections_.erase(fd);
+					continue;
+				}
+				if (connection.state == Connection::State::PROCESSING) {
+					workers.Push([this, fd, input = std::move(connection.input)] {
+						std::string output = ProcessDocument(input);
+						{
+							std::lock_guard lock(completed_mutex_);
+							completed_.emplace_back(fd, std::move(output));
+						}
+						Wake();
+					});
+				}
+			}
+		}
+		// Workers дожидается начатых документов, ответы на них уже не отправляются
+	}
+
+	void Server::AcceptConnections() {
+		while (true) {
+			const int fd = accept(listen_fd_, nullptr, nullptr);
+			if (fd < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				// EAGAIN - очередь пуста, прочие ошибки относятся к отдельному соединению
+				return;
+			}
+			SetNonBlocking(fd);
+			connections_.emplace(fd, Connection{});
+		}
+	}
+
+	bool Server::ReadInput(int fd, Connection& connection) {
+		char chunk[1 << 16];
+		while (true) {
+			const ssize_t size = read(fd, chunk, sizeof(chunk));
+			if (size > 0) {
+				connection.input.append(chunk, static_cast<size_t>(size));
+			}
+			else if (size == 0) {
+				connection.state = Connection::State::PROCESSING;
+				return true;
+			}
+			else if (errno == EINTR) {
+				continue;
+			}
+			else {
+				return errno == EAGAIN || errno == EWOULDBLOCK;
+			}
+		}
+	}
+
+	bool Server::WriteOutput(int fd, Connection& connection) {
+		while (connection.written_size < connection.output.size()) {
+			const ssize_t size = send(fd, connection.output.data() + connection.written_size,
+				connection.output.size() - connection.written_size, MSG_NOSIGNAL);
+			if (size >= 0) {
+				connection.written_size += static_cast<size_t>(size);
+			}
+			else if (errno == EINTR) {
+				continue;
+			}
+			else {
+				return errno == EAGAIN || errno == EWOULDBLOCK;
+			}
+		}
+		return false;
+	}
+
+	void Server::TakeCompletedResponses() {
+		char buffer[256];
+		while (read(wake_pipe_[0], buffer, sizeof(buffer)) > 0) {
+		}
+
+		std::vector<std::pair<int, std::string>> completed;
+		{
+			std::lock_guard lock(completed_mutex_);
+			completed.swap(completed_);
+		}
+		for (auto& [fd, output] : completed) {
+			Connection& connection = connections_.at(fd);
+			connection.output = std::move(output);
+			connection.state = Connection::State::WRITING;
+		}
+	}
+
+	// Будит цикл poll из потока пула
+	void Server::Wake() {
+		[[maybe_unused]] const ssize_t result = write(wake_pipe_[1], "w", 1);
+	}
+
+#endif
+
+} // namespace server
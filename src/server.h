@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace server {
+
+	struct Settings {
+		std::string socket_path;
+		std::string base_path;  // двоичная база, загружаемая до разбора JSON, может быть пустой
+		std::string input_path; // JSON с base_requests и настройками
+		size_t threads_count = 0; // 0 - по числу ядер
+		size_t cache_capacity = 0;
+		std::chrono::milliseconds request_timeout{ 0 }; // 0 - без ограничения
+		std::chrono::milliseconds batch_timeout{ 0 };
+	};
+
+	// Сервер на сокете Unix: справочник и роутер строятся один раз, а клиенты
+	// присылают документы {"stat_requests": [...]} и получают ответ в том же формате,
+	// что и при обычном запуске. Конец документа - закрытие клиентом записи (shutdown SHUT_WR),
+	// после ответа сервер закрывает соединение.
+	// Документ {"command": "reload"} заново загружает базу; запросы, начатые до замены,
+	// дорабатывают со старой версией. Файлы базы читаются в память, поэтому их можно
+	// перезаписывать на месте, пока сервер работает.
+	// Ввод-вывод обслуживает один поток с poll, ответы вычисляют потоки пула
+	class Server {
+	public:
+		explicit Server(Settings settings);
+		Server(const Server&) = delete;
+		Server& operator=(const Server&) = delete;
+		~Server();
+
+		// Обслуживает клиентов до получения SIGINT или SIGTERM
+		void Run();
+
+	private:
+		struct Snapshot;
+
+		struct Connection {
+			enum class State { READING, PROCESSING, WRITING };
+
+			State state = State::READING;
+			std::string input;
+			std::string output;
+			size_t written_size = 0;
+		};
+
+		// Очередь задач для потоков, вычисляющих ответы
+		class Workers {
+		public:
+			explicit Workers(size_t threads_count);
+			Workers(const Workers&) = delete;
+			Workers& operator=(const Workers&) = delete;
+			// Дожидается выполнения поставленных задач
+			~Workers();
+
+			void Push(std::function<void()> task);
+
+		private:
+			void WorkerLoop();
+
+			std::mutex mutex_;
+			std::condition_variable cv_;
+			std::deque<std::function<void()>> tasks_;
+			bool stopping_ = false;
+			std::vector<std::thread> threads_;
+		};
+
+		std::shared_ptr<const Snapshot> LoadSnapshot() const;
+		std::string ProcessDocument(const std::string& input);
+		void Reload();
+
+		void OpenSocket();
+		void AcceptConnections();
+		// Возвращают false, если соединение нужно закрыть
+		bool ReadInput(int fd, Connection& connection);
+		bool WriteOutput(int fd, Connection& connection);
+		void TakeCompletedResponses();
+		void Wake();
+
+		Settings settings_;
+		std::shared_ptr<const Snapshot> snapshot_; // заменяется через std::atomic_store
+		std::mutex reload_mutex_;
+
+		int listen_fd_ = -1;
+		int wake_pipe_[2] = { -1, -1 };
+		std::unordered_map<int, Connection> connections_;
+
+		std::mutex completed_mutex_;
+		std::vector<std::pair<int, std::string>> completed_;
+	};
+
+} // namespace server
@@ -0,0 +1,43 @@
+#include "string_storage.h"
+
+#include <cstring>
+#include <functional>
+
+namespace string_storage {
+
+	void StringStorage::AddSource(std::shared_ptr<const void> owner, std::string_view data) {
+		sources_.push_back({ std::move(owner), data });
+	}
+
+	std::string_view StringStorage::Store(std::string_view value) {
+		if (value.empty() || IsInSource(value)) {
+			return value;
+		}
+		// Длинная строка получает собственный блок, чтобы не тратить остаток текущего
+		if (value.size() > BLOCK_SIZE / 4) {
+			auto& block = blocks_.emplace_back(std::make_unique<char[]>(value.size()));
+			std::memcpy(block.get(), value.data(), value.size());
+			return { block.get(), value.size() };
+		}
+		if (BLOCK_SIZE - block_used_ < value.size()) {
+			current_block_ = blocks_.emplace_back(std::make_unique<char[]>(BLOCK_SIZE)).get();
+			block_used_ = 0;
+		}
+		char* data = current_block_ + block_used_;
+		std::memcpy(data, value.data(), value.size());
+		block_used_ += value.size();
+		return { data, value.size() };
+	}
+
+	bool StringStorage::IsInSource(std::string_view value) const {
+		const std::less<const char*> less;
+		for (const auto& [owner, data] : sources_) {
+			if (!less(value.data(), data.data())
+				&& !less(data.data() + data.size(), value.data() + value.size())) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+} // namespace string_storage
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace string_storage {
+
+	// Хранилище строк, на которые ссылаются объекты справочника.
+	// Строки из подключённых внешних буферов (например, отображённого входного файла)
+	// не копируются: хранилище лишь продлевает жизнь буфера. Остальные строки копируются
+	// в крупные блоки, а не в отдельные выделения памяти.
+	// Возвращаемые представления остаются валидными, пока жив объект, в том числе после перемещения
+	class StringStorage {
+	public:
+		// Строки, лежащие внутри data, будут храниться как представления; owner владеет data
+		void AddSource(std::shared_ptr<const void> owner, std::string_view data);
+		std::string_view Store(std::string_view value);
+
+	private:
+		static constexpr size_t BLOCK_SIZE = 1 << 16;
+
+		struct Source {
+			std::shared_ptr<const void> owner;
+			std::string_view data;
+		};
+
+		bool IsInSource(std::string_view value) const;
+
+		std::vector<Source> sources_;
+		std::vector<std::unique_ptr<char[]>> blocks_;
+		char* current_block_ = nullptr; // блок, в который копируются короткие строки
+		size_t block_used_ = BLOCK_SIZE;
+	};
+
+} // namespace string_storage
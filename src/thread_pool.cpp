@@ -0,0 +1,128 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace thread_pool {
+
+	ThreadPool::ThreadPool(size_t threads_count) {
+		if (threads_count == 0) {
+			threads_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+		}
+		queues_.reserve(threads_count);
+		for (size_t i = 0; i < threads_count; ++i) {
+			queues_.push_back(std::make_unique<Queue>());
+		}
+		// Поток с номером 0 - вызывающий
+		threads_.reserve(threads_count - 1);
+		for (size_t i = 1; i < threads_count; ++i) {
+			threads_.emplace_back([this, i] {
+				WorkerLoop(i);
+				});
+		}
+	}
+
+	ThreadPool::~ThreadPool() {
+		{
+			std::lock_guard lock(mutex_);
+			stopping_ = true;
+		}
+		start_cv_.notify_all();
+		for (auto& thread : threads_) {
+			thread.join();
+		}
+	}
+
+	size_t ThreadPool::GetThreadsCount() const {
+		return queues_.size();
+	}
+
+	void ThreadPool::Run(size_t chunks_count, const std::function<void(size_t, size_t)>& task) {
+		const size_t threads_count = queues_.size();
+		for (size_t i = 0; i < threads_count; ++i) {
+			std::lock_guard lock(queues_[i]->mutex);
+			queues_[i]->begin = chunks_count * i / threads_count;
+			queues_[i]->end = chunks_count * (i + 1) / threads_count;
+		}
+		{
+			std::lock_guard lock(mutex_);
+			task_ = &task;
+			error_ = nullptr;
+			busy_workers_ = threads_.size();
+			++generation_;
+		}
+		start_cv_.notify_all();
+
+		RunChunks(0);
+
+		std::unique_lock lock(mutex_);
+		done_cv_.wait(lock, [this] {
+			return busy_workers_ == 0;
+			});
+		task_ = nullptr;
+		if (error_) {
+			std::rethrow_exception(std::exchange(error_, nullptr));
+		}
+	}
+
+	void ThreadPool::WorkerLoop(size_t worker_index) {
+		size_t seen_generation = 0;
+		while (true) {
+			{
+				std::unique_lock lock(mutex_);
+				start_cv_.wait(lock, [this, seen_generation] {
+					return stopping_ || generation_ != seen_generation;
+					});
+				if (stopping_) {
+					return;
+				}
+				seen_generation = generation_;
+			}
+
+			RunChunks(worker_index);
+
+			{
+				std::lock_guard lock(mutex_);
+				--busy_workers_;
+			}
+			done_cv_.notify_one();
+		}
+	}
+
+	void ThreadPool::RunChunks(size_t worker_index) {
+		size_t chunk = 0;
+		while (PopChunk(worker_index, chunk)) {
+			try {
+				(*task_)(worker_index, chunk);
+			}
+			catch (...) {
+				std::lock_guard lock(mutex_);
+				if (!error_) {
+					error_ = std::current_exception();
+				}
+			}
+		}
+	}
+
+	// Берёт часть из начала своей очереди, а если она пуста - из конца чужой
+	bool ThreadPool::PopChunk(size_t worker_index, size_t& chunk) {
+		{
+			Queue& own = *queues_[worker_index];
+			std::lock_guard lock(own.mutex);
+			if (own.begin != own.end) {
+				chunk = own.begin++;
+				return true;
+			}
+		}
+		for (size_t offset = 1; offset < queues_.size(); ++offset) {
+			Queue& victim = *queues_[(worker_index + offset) % queues_.size()];
+			std::lock_guard lock(victim.mutex);
+			if (victim.begin != victim.end) {
+				chunk = --victim.end;
+				return true;
+			}
+		}
+		return false;
+	}
+
+} // namespace thread_pool
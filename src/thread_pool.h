@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace thread_pool {
+
+	// Пул потоков с перехватом работы. Части задачи заранее раскладываются
+	// по очередям потоков непрерывными отрезками; поток, закончивший свою очередь,
+	// забирает части с конца чужих очередей
+	class ThreadPool {
+	public:
+		// threads_count - число потоков вместе с вызывающим, 0 - по числу ядер
+		explicit ThreadPool(size_t threads_count);
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+		~ThreadPool();
+
+		size_t GetThreadsCount() const;
+
+		// Выполняет task(worker_index, chunk_index) для всех частей из [0, chunks_count)
+		// и дожидается завершения. worker_index < GetThreadsCount() позволяет потокам
+		// держать собственное состояние. Первое исключение из task передаётся вызывающему
+		void Run(size_t chunks_count, const std::function<void(size_t, size_t)>& task);
+
+	private:
+		struct Queue {
+			std::mutex mutex;
+			size_t begin = 0;
+			size_t end = 0;
+		};
+
+		void WorkerLoop(size_t worker_index);
+		void RunChunks(size_t worker_index);
+		bool PopChunk(size_t worker_index, size_t& chunk);
+
+		std::vector<std::unique_ptr<Queue>> queues_;
+		std::vector<std::thread> threads_;
+
+		std::mutex mutex_;
+		std::condition_variable start_cv_;
+		std::condition_variable done_cv_;
+		const std::function<void(size_t, size_t)>* task_ = nullptr;
+		size_t generation_ = 0;
+		size_t busy_workers_ = 0;
+		bool stopping_ = false;
+		std::exception_ptr error_;
+	};
+
+} // namespace thread_pool
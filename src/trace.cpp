@@ -0,0 +1,128 @@
+#include "trace.h"
+
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "json_writer.h"
+
+using namespace std::literals;
+
+namespace trace {
+
+	namespace {
+
+		struct Event {
+			std::string_view name;
+			std::string_view category;
+			std::optional<int> request_id;
+			std::chrono::steady_clock::time_point start;
+			std::chrono::steady_clock::time_point end;
+		};
+
+		struct ThreadEvents {
+			int thread_id;
+			std::vector<Event> events;
+		};
+
+		std::atomic<bool> enabled{ false };
+		std::chrono::steady_clock::time_point start_time;
+		std::ofstream output;
+
+		// Буферы потоков принадлежат реестру, поэтому переживают потоки пула
+		std::mutex threads_mutex;
+		std::vector<std::unique_ptr<ThreadEvents>> threads;
+		thread_local ThreadEvents* current_thread = nullptr;
+
+		ThreadEvents& GetThreadEvents() {
+			if (!current_thread) {
+				std::lock_guard lock(threads_mutex);
+				threads.push_back(std::make_unique<ThreadEvents>());
+				threads.back()->thread_id = static_cast<int>(threads.size());
+				current_thread = threads.back().get();
+			}
+			return *current_thread;
+		}
+
+		double ToMicroseconds(std::chrono::steady_clock::duration duration) {
+			return std::chrono::duration<double, std::micro>(duration).count();
+		}
+
+	} // namespace
+
+	void Start(const std::string& path) {
+		output.open(path, std::ios::binary);
+		if (!output) {
+			throw std::runtime_error("Cannot open file '"s + path + "'"s);
+		}
+		start_time = std::chrono::steady_clock::now();
+		enabled.store(true, std::memory_order_release);
+	}
+
+	bool IsEnabled() {
+		return enabled.load(std::memory_order_relaxed);
+	}
+
+	// Вызывается, когда другие потоки уже не записывают события
+	void Finish() {
+		if (!IsEnabled()) {
+			return;
+		}
+		enabled.store(false, std::memory_order_relaxed);
+
+		std::lock_guard lock(threads_mutex);
+		json::Writer writer(output, json::NumberFormat::SHORTEST, json::Layout::COMPACT);
+		auto events_context = writer.StartDict()
+			.Key("displayTimeUnit").Value("ms"s)
+			.Key("traceEvents").StartArray();
+		for (const auto& thread : threads) {
+			events_context.StartDict()
+				.Key("args").StartDict().Key("name").Value("thread "s + std::to_string(thread->thread_id)).EndDict()
+				.Key("name").Value("thread_name"s)
+				.Key("ph").Value("M"s)
+				.Key("pid").Value(1)
+				.Key("tid").Value(thread->thread_id)
+				.EndDict();
+			for (const Event& event : thread->events) {
+				auto event_context = events_context.StartDict();
+				if (event.request_id) {
+					event_context.Key("args").StartDict().Key("id").Value(*event.request_id).EndDict();
+				}
+				event_context.Key("cat").Value(event.category)
+					.Key("dur").Value(ToMicroseconds(event.end - event.start))
+					.Key("name").Value(event.name)
+					.Key("ph").Value("X"s)
+					.Key("pid").Value(1)
+					.Key("tid").Value(thread->thread_id)
+					.Key("ts").Value(ToMicroseconds(event.start - start_time))
+					.EndDict();
+			}
+		}
+		events_context.EndArray().EndDict();
+		writer.Finish();
+		output << '\n';
+		output.close();
+	}
+
+	// ===== class ScopedSpan =====
+
+	ScopedSpan::ScopedSpan(std::string_view name, std::string_view category, std::optional<int> request_id)
+		: name_(name)
+		, category_(category)
+		, request_id_(request_id)
+		, enabled_(IsEnabled()) {
+		if (enabled_) {
+			start_ = std::chrono::steady_clock::now();
+		}
+	}
+
+	ScopedSpan::~ScopedSpan() {
+		if (enabled_) {
+			GetThreadEvents().events.push_back({ name_, category_, request_id_, start_, std::chrono::steady_clock::now() });
+		}
+	}
+
+} // namespace trace
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace trace {
+
+	// Запись отрезков времени в формате Chrome trace event (about://tracing, Perfetto).
+	// Каждый поток складывает события в собственный буфер без блокировок.
+	// Пока запись не включена, ScopedSpan ограничивается проверкой флага
+	void Start(const std::string& path);
+	bool IsEnabled();
+	// Сохраняет события всех потоков в файл, указанный в Start
+	void Finish();
+
+	// Отрезок от создания до выхода из области видимости.
+	// name и category должны жить до вызова Finish, обычно это строковые литералы
+	class ScopedSpan {
+	public:
+		ScopedSpan(std::string_view name, std::string_view category,
+			std::optional<int> request_id = std::nullopt);
+		ScopedSpan(const ScopedSpan&) = delete;
+		ScopedSpan& operator=(const ScopedSpan&) = delete;
+		~ScopedSpan();
+
+	private:
+		std::string_view name_;
+		std::string_view category_;
+		std::optional<int> request_id_;
+		bool enabled_;
+		std::chrono::steady_clock::time_point start_;
+	};
+
+} // namespace trace
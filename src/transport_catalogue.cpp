@@ -1,23 +1,134 @@
 #include "transport_catalogue.h"
 
-#include <sstream>
+#include <algorithm>
+#include <future>
+#include <iterator>
+#include <stdexcept>
 #include <unordered_set>
 
 using namespace std::string_literals;
 
 namespace transport_catalogue {
 
-	void TransportCatalogue::AddStop(const Stop& stop) {
+	namespace {
+		template <typename Value>
+		perfect_hash::PerfectHashMap<Value> BuildNameIndex(const std::unordered_map<std::string_view, Value>& names) {
+			return perfect_hash::PerfectHashMap<Value>({ names.begin(), names.end() });
+		}
+	} // namespace
+
+	void TransportCatalogue::AddBase(const std::vector<StopDescription>& stops,
+		const std::vector<IndexedDistanceDescription>& distances,
+		const std::vector<IndexedBusDescription>& buses) {
+		const size_t first_new_stop_id = stops_.size();
+		const std::vector<const Stop*> stops_by_index = AddStops(stops);
+		const auto get_stop = [&stops_by_index](uint32_t index) -> const Stop* {
+			if (index >= stops_by_index.size()) {
+				throw std::out_of_range("Stop index is out of range"s);
+			}
+			return stops_by_index[index];
+		};
+
+		std::vector<ResolvedDistance> resolved_distances;
+		resolved_distances.reserve(distances.size());
+		for (const auto& [from, to, distance] : distances) {
+			resolved_distances.push_back({ { get_stop(from), get_stop(to) }, distance });
+		}
+
+		std::vector<Bus> resolved_buses(buses.size());
+		for (size_t i = 0; i < buses.size(); ++i) {
+			const IndexedBusDescription& description = buses[i];
+			Bus& bus = resolved_buses[i];
+			bus.bus_name = description.name;
+			bus.is_circular = description.is_roundtrip;
+			bus.bus_stops.reserve(description.stops.size());
+			for (uint32_t index : description.stops) {
+				bus.bus_stops.push_back(get_stop(index));
+			}
+		}
+
+		AddResolved(first_new_stop_id, resolved_distances, resolved_buses);
+	}
+
+	// Порядок добавления определяет stop_id, поэтому шаг последовательный.
+	// Возвращает остановку справочника для каждого описания, в том числе для повторов
+	std::vector<const Stop*> TransportCatalogue::AddStops(const std::vector<StopDescription>& stops) {
+		indexes_built_ = false;
+		++version_;
+		std::vector<const Stop*> added_stops;
+		added_stops.reserve(stops.size());
+		stopname_to_stop_.reserve(stopname_to_stop_.size() + stops.size());
+		for (const auto& [name, position] : stops) {
+			if (auto it = stopname_to_stop_.find(name); it != stopname_to_stop_.end()) {
+				added_stops.push_back(it->second);
+				continue;
+			}
+			Stop& added_stop = stops_.emplace_back(Stop{ names_.Store(name), position, stops_.size() });
+			stopname_to_stop_.emplace(added_stop.stop_name, &added_stop);
+			added_stops.push_back(&added_stop);
+		}
+		return added_stops;
+	}
+
+	void TransportCatalogue::AddResolved(size_t first_new_stop_id,
+		const std::vector<ResolvedDistance>& distances, std::vector<Bus>& buses) {
+		// Параллельно: sin/cos координат новых остановок, таблица расстояний
+		// и маршруты с индексом остановок
+		auto coordinates_task = std::async(std::launch::async, [this, first_new_stop_id] {
+			stops_coordinates_.Reserve(stops_.size());
+			for (size_t stop_id = first_new_stop_id; stop_id < stops_.size(); ++stop_id) {
+				stops_coordinates_.Add(stops_[stop_id].position);
+			}
+			});
+
+		auto distances_task = std::async(std::launch::async, [this, &distances] {
+			distance_between_stops_.reserve(distance_between_stops_.size() + distances.size());
+			for (const auto& [stops_pair, distance] : distances) {
+				if (stops_pair.first && stops_pair.second) {
+					distance_between_stops_.emplace(stops_pair, distance);
+				}
+			}
+			});
+
+		busname_to_bus_.reserve(busname_to_bus_.size() + buses.size());
+		for (Bus& bus : buses) {
+			if (busname_to_bus_.count(bus.bus_name)) {
+				continue;
+			}
+			bus.bus_name = names_.Store(bus.bus_name);
+			const Bus& added_bus = buses_.emplace_back(std::move(bus));
+			busname_to_bus_.emplace(added_bus.bus_name, &added_bus);
+		}
+		BuildIndexes();
+
+		coordinates_task.get();
+		distances_task.get();
+	}
+
+	void TransportCatalogue::AddNameSource(std::shared_ptr<const void> owner, std::string_view data) {
+		names_.AddSource(std::move(owner), data);
+	}
+
+	void TransportCatalogue::AddStop(Stop stop) {
 		auto it = stopname_to_stop_.find(stop.stop_name);
 		if (it != stopname_to_stop_.end()) {
 			return;
 		}
-		stops_.push_back(stop);
-		const Stop& added_stop = stops_.back();
+		stop.stop_name = names_.Store(stop.stop_name);
+		stops_.push_back(std::move(stop));
+		Stop& added_stop = stops_.back();
+		added_stop.stop_id = stops_.size() - 1;
 		stopname_to_stop_.insert({ added_stop.stop_name, &added_stop });
+		stops_coordinates_.Add(added_stop.position);
+		indexes_built_ = false;
+		++version_;
 	}
 
 	const Stop* TransportCatalogue::FindStop(std::string_view stop_name) const {
+		if (indexes_built_) {
+			const auto* stop = stop_index_.Find(stop_name);
+			return stop ? *stop : nullptr;
+		}
 		auto it = stopname_to_stop_.find(stop_name);
 		if (it == stopname_to_stop_.end()) {
 			return nullptr;
@@ -25,21 +136,24 @@ namespace transport_catalogue {
 		return it->second;
 	}
 
-	void TransportCatalogue::AddBus(const Bus& bus) {
+	void TransportCatalogue::AddBus(Bus bus) {
 		auto it = busname_to_bus_.find(bus.bus_name);
 		if (it != busname_to_bus_.end()) {
 			return;
 		}
-		buses_.push_back(bus);
+		bus.bus_name = names_.Store(bus.bus_name);
+		buses_.push_back(std::move(bus));
 		const Bus& added_bus = buses_.back();
 		busname_to_bus_.insert({ added_bus.bus_name, &added_bus });
-
-		for (const Stop* stop_name : added_bus.bus_stops) {
-			stop_to_buses_[stop_name].insert(added_bus.bus_name);
-		}
+		indexes_built_ = false;
+		++version_;
 	}
 
 	const Bus* TransportCatalogue::FindBus(std::string_view bus_name) const {
+		if (indexes_built_) {
+			const auto* bus = bus_index_.Find(bus_name);
+			return bus ? *bus : nullptr;
+		}
 		auto it = busname_to_bus_.find(bus_name);
 		if (it == busname_to_bus_.end()) {
 			return nullptr;
@@ -50,24 +164,26 @@ namespace transport_catalogue {
 	BusInfo TransportCatalogue::GetBusInfo(std::string_view bus_name) const {
 		BusInfo bus_info;
 
-		auto it = busname_to_bus_.find(bus_name);
-		if (it == busname_to_bus_.end()) {
+		const Bus* bus = FindBus(bus_name);
+		if (!bus) {
 			return bus_info;
 		}
 		bus_info.bus_found = true;
 
-		const Bus* bus = it->second;
-		bus_info.stops_count = bus->bus_stops.size();
+		const RouteView route = bus->GetRoute();
+		bus_info.stops_count = route.size();
 		std::unordered_set<const Stop*> unique_stops(bus->bus_stops.begin(), bus->bus_stops.end());
 		bus_info.unique_stops_count = unique_stops.size();
 
-		double geo_distance = 0.0;
-		for (size_t i = 0; i < bus->bus_stops.size() - 1; i++) {
-			const Stop* stop_1 = bus->bus_stops[i];
-			const Stop* stop_2 = bus->bus_stops[i + 1];
+		geo::CoordinatesBatch route_points;
+		route_points.Reserve(route.size());
+		for (const Stop* stop : route) {
+			route_points.Add(stops_coordinates_, stop->stop_id);
+		}
+		double geo_distance = geo::ComputePathLength(route_points);
 
-			geo_distance += geo::ComputeDistance(stop_1->position, stop_2->position);
-			bus_info.route_length += GetDistanceBetweenStops(stop_1, stop_2);
+		for (size_t i = 0; i + 1 < route.size(); i++) {
+			bus_info.route_length += GetDistanceBetweenStops(route[i], route[i + 1]);
 		}
 
 		if (geo_distance > 0.0) {
@@ -77,14 +193,69 @@ namespace transport_catalogue {
 		return bus_info;
 	}
 
-	const std::set<std::string_view>& TransportCatalogue::GetBusesForStop(const Stop* stop) const {
-		static const std::set<std::string_view> empty_buses;
+	void TransportCatalogue::BuildIndexes() {
+		auto stop_index_task = std::async(std::launch::async, [this] {
+			return BuildNameIndex(stopname_to_stop_);
+			});
+		auto bus_index_task = std::async(std::launch::async, [this] {
+			return BuildNameIndex(busname_to_bus_);
+			});
 
-		auto it = stop_to_buses_.find(stop);
-		if (it == stop_to_buses_.end()) {
-			return empty_buses;
+		// Подсчёт числа вхождений маршрутов в каждую остановку
+		stop_buses_offsets_.assign(stops_.size() + 1, 0);
+		for (const Bus& bus : buses_) {
+			for (const Stop* stop : bus.bus_stops) {
+				++stop_buses_offsets_[stop->stop_id + 1];
+			}
 		}
-		return it->second;
+		for (size_t i = 1; i < stop_buses_offsets_.size(); ++i) {
+			stop_buses_offsets_[i] += stop_buses_offsets_[i - 1];
+		}
+
+		stop_buses_.resize(stop_buses_offsets_.back());
+		std::vector<size_t> positions(stop_buses_offsets_.begin(), stop_buses_offsets_.end() - 1);
+		for (const Bus& bus : buses_) {
+			for (const Stop* stop : bus.bus_stops) {
+				stop_buses_[positions[stop->stop_id]++] = bus.bus_name;
+			}
+		}
+
+		// Сортировка и удаление повторов внутри каждой остановки с уплотнением массива
+		size_t size = 0;
+		for (size_t stop_id = 0; stop_id < stops_.size(); ++stop_id) {
+			auto begin = stop_buses_.begin() + stop_buses_offsets_[stop_id];
+			auto end = stop_buses_.begin() + stop_buses_offsets_[stop_id + 1];
+			std::sort(begin, end);
+			end = std::unique(begin, end);
+
+			stop_buses_offsets_[stop_id] = size;
+			size = std::move(begin, end, stop_buses_.begin() + size) - stop_buses_.begin();
+		}
+		stop_buses_offsets_.back() = size;
+		stop_buses_.resize(size);
+		stop_buses_.shrink_to_fit();
+
+		stop_index_ = stop_index_task.get();
+		bus_index_ = bus_index_task.get();
+		indexes_built_ = true;
+	}
+
+	BusesRange TransportCatalogue::GetBusesForStop(const Stop* stop) const {
+		if (!indexes_built_) {
+			throw std::logic_error("Catalogue indexes are not built"s);
+		}
+		return BusesRange{ stop_buses_.begin() + stop_buses_offsets_[stop->stop_id],
+			stop_buses_.begin() + stop_buses_offsets_[stop->stop_id + 1] };
+	}
+
+	std::vector<std::string_view> TransportCatalogue::GetCommonBuses(const Stop* stop_1, const Stop* stop_2) const {
+		const BusesRange buses_1 = GetBusesForStop(stop_1);
+		const BusesRange buses_2 = GetBusesForStop(stop_2);
+
+		std::vector<std::string_view> common_buses;
+		std::set_intersection(buses_1.begin(), buses_1.end(), buses_2.begin(), buses_2.end(),
+			std::back_inserter(common_buses));
+		return common_buses;
 	}
 
 	void TransportCatalogue::AddDistanceBetweenStops(std::string_view stop_name_from,
@@ -101,6 +272,7 @@ namespace transport_catalogue {
 		}
 
 		distance_between_stops_[{ stop_from, stop_to}] = distance;
+		++version_;
 	}
 
 	unsigned int TransportCatalogue::GetDistanceBetweenStops(const Stop* stop_from, const Stop* stop_to) const {
@@ -120,6 +292,14 @@ namespace transport_catalogue {
 		return stops_;
 	}
 
+	uint64_t TransportCatalogue::GetVersion() const {
+		return version_;
+	}
+
+	const TransportCatalogue::DistancesTable& TransportCatalogue::GetAllDistances() const {
+		return distance_between_stops_;
+	}
+
 	const std::deque<Bus>& TransportCatalogue::GetAllBuses() const {
 		return buses_;
 	}
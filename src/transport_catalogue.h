@@ -1,7 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <deque>
-#include <set>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -9,6 +10,9 @@
 #include <vector>
 
 #include "domain.h"
+#include "perfect_hash.h"
+#include "ranges.h"
+#include "string_storage.h"
 
 namespace transport_catalogue {
 	using namespace domain;
@@ -24,28 +28,86 @@ namespace transport_catalogue {
 		std::hash<const Stop*> stop_hasher_;
 	};
 
+	using BusesRange = ranges::Range<std::vector<std::string_view>::const_iterator>;
+
+	// Описания элементов базы для пакетной загрузки.
+	// Строки должны оставаться валидными на время вызова AddBase
+	struct StopDescription {
+		std::string_view name;
+		geo::Coordinates position;
+	};
+
+	// Описания со ссылками на остановки по номеру в списке остановок того же вызова AddBase
+	struct IndexedDistanceDescription {
+		uint32_t from;
+		uint32_t to;
+		unsigned int distance;
+	};
+
+	struct IndexedBusDescription {
+		std::string_view name;
+		ranges::Range<const uint32_t*> stops;
+		bool is_roundtrip;
+	};
+
 	class TransportCatalogue {
 	public:
-		void AddStop(const Stop& stop);
+		using DistancesTable = std::unordered_map<std::pair<const Stop*, const Stop*>, unsigned int, PairStopsHash>;
+
+		// Пакетная загрузка: резервирует память под все таблицы и строит индексы параллельно.
+		// Результат совпадает с поэлементным добавлением и последующим BuildIndexes.
+		// Остановки маршрутов и расстояний задаются номерами в списке stops
+		void AddBase(const std::vector<StopDescription>& stops,
+			const std::vector<IndexedDistanceDescription>& distances,
+			const std::vector<IndexedBusDescription>& buses);
+		// Названия из data не копируются, справочник хранит их как представления
+		// и продлевает жизнь owner. Остальные названия копируются при добавлении
+		void AddNameSource(std::shared_ptr<const void> owner, std::string_view data);
+		void AddStop(Stop stop);
 		const Stop* FindStop(std::string_view stop_name) const;
-		void AddBus(const Bus& bus);
+		void AddBus(Bus bus);
 		const Bus* FindBus(std::string_view bus_name) const;
 		BusInfo GetBusInfo(std::string_view bus_name) const;
-		const std::set<std::string_view>& GetBusesForStop(const Stop* stop) const;
+		// Строит производные индексы; вызывается по окончании загрузки.
+		// До этого поиск по названиям идёт через хеш-таблицы загрузки
+		void BuildIndexes();
+		// Маршруты через остановку в порядке возрастания названий
+		BusesRange GetBusesForStop(const Stop* stop) const;
+		// Маршруты, проходящие через обе остановки
+		std::vector<std::string_view> GetCommonBuses(const Stop* stop_1, const Stop* stop_2) const;
 		void AddDistanceBetweenStops(std::string_view stop_name_from,
 			std::string_view stop_name_to, unsigned int distance);
 		unsigned int GetDistanceBetweenStops(const Stop* stop_from, const Stop* stop_to) const;
 		const std::deque<Stop>& GetAllStops() const;
 		const std::deque<Bus>& GetAllBuses() const;
+		const DistancesTable& GetAllDistances() const;
 		size_t GetStopsCount() const;
+		// Меняется при каждом изменении данных; позволяет проверять актуальность кешей
+		uint64_t GetVersion() const;
 
 	private:
+		using ResolvedDistance = std::pair<std::pair<const Stop*, const Stop*>, unsigned int>;
+
+		std::vector<const Stop*> AddStops(const std::vector<StopDescription>& stops);
+		void AddResolved(size_t first_new_stop_id,
+			const std::vector<ResolvedDistance>& distances, std::vector<Bus>& buses);
+
+		string_storage::StringStorage names_;
 		std::deque<Stop> stops_;
 		std::unordered_map<std::string_view, const Stop*> stopname_to_stop_;
+		geo::CoordinatesBatch stops_coordinates_; // по индексу stop_id
 		std::deque<Bus> buses_;
 		std::unordered_map<std::string_view, const Bus*> busname_to_bus_;
-		std::unordered_map<const Stop*, std::set<std::string_view>> stop_to_buses_;
-		std::unordered_map<std::pair<const Stop*, const Stop*>, unsigned int, PairStopsHash> distance_between_stops_;
+		// Маршруты через остановку stop_id лежат в stop_buses_
+		// на отрезке [stop_buses_offsets_[stop_id], stop_buses_offsets_[stop_id + 1])
+		std::vector<size_t> stop_buses_offsets_;
+		std::vector<std::string_view> stop_buses_;
+		// Индексы названий для поиска после загрузки, когда наборы названий уже не меняются
+		perfect_hash::PerfectHashMap<const Stop*> stop_index_;
+		perfect_hash::PerfectHashMap<const Bus*> bus_index_;
+		bool indexes_built_ = false;
+		uint64_t version_ = 0;
+		DistancesTable distance_between_stops_;
 	};
 
 } // namespace transport_catalogue
\ No newline at end of file
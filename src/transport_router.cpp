@@ -1,5 +1,7 @@
 #include "transport_router.h"
 
+#include "profiler.h"
+
 namespace transport_router {
 
 	using namespace graph;
@@ -9,10 +11,23 @@ namespace transport_router {
 		: catalogue_(catalogue)
 		, routing_settings_(routing_settings)
 		, graph_(BuildGraph())
-		, router_(std::make_unique<Router<double>>(*graph_)) {
+		, router_(BuildRouter()) {
+	}
+
+	size_t TransportRouter::GetVertexCount() const {
+		return graph_->GetVertexCount();
+	}
+
+	size_t TransportRouter::GetEdgeCount() const {
+		return graph_->GetEdgeCount();
 	}
 
-	std::optional<RouteData> TransportRouter::FindRoute(const std::string& from, const std::string& to) const {
+	uint64_t TransportRouter::GetRelaxationsCount() const {
+		return router_->GetRelaxationsCount();
+	}
+
+	std::optional<RouteData> TransportRouter::FindRoute(std::string_view from, std::string_view to,
+		const deadline::Deadline& deadline) const {
 		const Stop* stop_from = catalogue_.FindStop(from);
 		const Stop* stop_to = catalogue_.FindStop(to);
 
@@ -20,7 +35,11 @@ namespace transport_router {
 			return std::nullopt;
 		}
 
-		auto route_info = router_->BuildRoute(stops_id_.at(stop_from), stops_id_.at(stop_to));
+		// Check читает часы раз в несколько сотен рёбер, поэтому срок короткого маршрута
+		// проверяется ещё раз после восстановления
+		auto route_info = router_->BuildRoute(stops_id_.at(stop_from), stops_id_.at(stop_to),
+			[&deadline] { deadline.Check(); });
+		deadline.CheckNow();
 		if (!route_info) {
 			return std::nullopt;
 		}
@@ -51,7 +70,13 @@ namespace transport_router {
 		return route_data;
 	}
 
+	std::unique_ptr<Router<double>> TransportRouter::BuildRouter() const {
+		const profiler::ScopedPhase phase("router_precompute");
+		return std::make_unique<Router<double>>(*graph_);
+	}
+
 	std::unique_ptr<DirectedWeightedGraph<double>> TransportRouter::BuildGraph() {
+		const profiler::ScopedPhase phase("build_graph");
 		auto unique_buses = GetUniqueBuses(catalogue_.GetAllBuses());
 		SetIdForStops(unique_buses);
 
@@ -85,7 +110,7 @@ namespace transport_router {
 	}
 
 	void TransportRouter::AddBusEdges(DirectedWeightedGraph<double>& graph, const domain::Bus* bus) {
-		const auto& stops = bus->bus_stops;
+		const RouteView stops = bus->GetRoute();
 		for (size_t i = 0; i + 1 < stops.size(); ++i) {
 			double total_forward_distance = 0.0;
 			double total_backward_distance = 0.0;
@@ -104,7 +129,7 @@ namespace transport_router {
 	}
 
 	void TransportRouter::AddGraphEdge(DirectedWeightedGraph<double>& graph, 
-		const Stop* from, const Stop* to, const std::string& bus_name, 
+		const Stop* from, const Stop* to, std::string_view bus_name, 
 		double cumulative_distance, size_t span_count) {
 
 		double travel_time = cumulative_distance / (routing_settings_.bus_velocity * KMH_TO_MPM); // [min]
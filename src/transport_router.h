@@ -3,6 +3,7 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include "deadline.h"
 #include "graph.h"
 #include "router.h"
 #include "transport_catalogue.h"
@@ -21,15 +22,15 @@ namespace transport_router {
 	};
 
 	struct EdgeData {
-		std::string bus_name;
+		std::string_view bus_name;
 		size_t span_count = 0;
 	};
 
 	struct RouteItems {
 		enum class Type { Wait, Bus };
 		Type type;
-		std::string stop_name;
-		std::string bus_name;
+		std::string_view stop_name;
+		std::string_view bus_name;
 		size_t span_count = 0;
 		double time = 0.0;
 	};
@@ -43,7 +44,13 @@ namespace transport_router {
 	public:
 		TransportRouter(const TransportCatalogue& catalogue, const RoutingSettings& routing_settings);
 
-		std::optional<RouteData> FindRoute(const std::string& from, const std::string& to) const;
+		// При истечении deadline бросает deadline::DeadlineExceeded
+		std::optional<RouteData> FindRoute(std::string_view from, std::string_view to,
+			const deadline::Deadline& deadline = {}) const;
+
+		size_t GetVertexCount() const;
+		size_t GetEdgeCount() const;
+		uint64_t GetRelaxationsCount() const;
 
 	private:
 		const TransportCatalogue& catalogue_;
@@ -55,6 +62,7 @@ namespace transport_router {
 		std::unique_ptr<Router<double>> router_;
 
 		std::unique_ptr<DirectedWeightedGraph<double>> BuildGraph();
+		std::unique_ptr<Router<double>> BuildRouter() const;
 
 		std::unordered_set<const domain::Bus*> GetUniqueBuses(const std::deque<domain::Bus>& buses) const;
 
@@ -63,7 +71,7 @@ namespace transport_router {
 		void AddBusEdges(DirectedWeightedGraph<double>& graph, const domain::Bus* bus);
 
 		void AddGraphEdge(DirectedWeightedGraph<double>& graph, 
-			const Stop* from, const Stop* to, const std::string& bus_name, 
+			const Stop* from, const Stop* to, std::string_view bus_name, 
 			double cumulative_distance, size_t span_count);
 	};
 
@@ -0,0 +1,147 @@
+// Проверка загрузки двоичной базы: отказ на повреждённых данных и совпадение ответов после преобразования.
+// Сборка и запуск из корня репозитория:
+//   g++ -std=c++17 -pthread -Isrc tests/base_binary_test.cpp $(ls src/*.cpp | grep -v '/main.cpp') -o base_binary_test
+//   ./base_binary_test
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "base_binary.h"
+#include "json_reader.h"
+#include "transport_catalogue.h"
+
+using namespace std::literals;
+
+namespace {
+
+	const std::string BASE_REQUESTS = R"([
+		{"type": "Stop", "name": "A", "latitude": 55.61, "longitude": 37.20, "road_distances": {"B": 1000}},
+		{"type": "Stop", "name": "B", "latitude": 55.62, "longitude": 37.21, "road_distances": {"C": 2000}},
+		{"type": "Stop", "name": "C", "latitude": 55.63, "longitude": 37.22, "road_distances": {}},
+		{"type": "Bus", "name": "1", "stops": ["A", "B", "C"], "is_roundtrip": false}
+	])";
+
+	const std::string SECTIONS = R"(
+		"routing_settings": {"bus_wait_time": 6, "bus_velocity": 40},
+		"stat_requests": [
+			{"id": 1, "type": "Bus", "name": "1"},
+			{"id": 2, "type": "Stop", "name": "B"},
+			{"id": 3, "type": "Route", "from": "A", "to": "C"},
+			{"id": 4, "type": "Route", "from": "C", "to": "A"}
+		])";
+
+	// Расположение полей в файле базы из BASE_REQUESTS: заголовок из 48 байт,
+	// затем разделы, выровненные на 8 байт
+	constexpr size_t SIGNATURE_OFFSET = 0;
+	constexpr size_t VERSION_OFFSET = 4;
+	constexpr size_t BYTE_ORDER_OFFSET = 8;
+	constexpr size_t STOP_NAME_OFFSETS_OFFSET = 48; // uint32[4]
+	constexpr size_t DISTANCES_OFFSET = 120;        // uint32[2 * 3]
+	constexpr size_t ROUTE_STOPS_OFFSET = 160;      // uint32[3]
+
+	std::string MakeBase() {
+		transport_catalogue::TransportCatalogue catalogue;
+		transport_catalogue::JsonReader reader(catalogue);
+		reader.ParseInput("{\"base_requests\": "s + BASE_REQUESTS + "}"s);
+		std::ostringstream output;
+		base_binary::WriteBase(catalogue, output);
+		return output.str();
+	}
+
+	void SetUint32(std::string& data, size_t offset, uint32_t value) {
+		std::memcpy(data.data() + offset, &value, sizeof(value));
+	}
+
+	// true, если загрузка data завершилась FormatError с fragment в сообщении
+	bool Rejects(const std::string& data, const std::string& fragment) {
+		transport_catalogue::TransportCatalogue catalogue;
+		std::istringstream input(data);
+		try {
+			base_binary::LoadBase(input, catalogue);
+		}
+		catch (const base_binary::FormatError& e) {
+			return std::string(e.what()).find(fragment) != std::string::npos;
+		}
+		return false;
+	}
+
+	bool TestWrongSignature() {
+		std::string data = MakeBase();
+		data[SIGNATURE_OFFSET] = 'X';
+		return Rejects(data, "not a binary base"s);
+	}
+
+	bool TestWrongVersionAndByteOrder() {
+		std::string data = MakeBase();
+		SetUint32(data, VERSION_OFFSET, 2);
+		std::string swapped = MakeBase();
+		SetUint32(swapped, BYTE_ORDER_OFFSET, 0x04030201);
+		return Rejects(data, "version"s) && Rejects(swapped, "byte order"s);
+	}
+
+	bool TestTruncated() {
+		const std::string data = MakeBase();
+		return Rejects(data.substr(0, 20), "truncated"s)
+			&& Rejects(data.substr(0, data.size() - 8), "truncated"s);
+	}
+
+	bool TestNonMonotonicOffsets() {
+		std::string data = MakeBase();
+		SetUint32(data, STOP_NAME_OFFSETS_OFFSET + sizeof(uint32_t), 3);
+		return Rejects(data, "stop name offsets"s);
+	}
+
+	bool TestStopIndexOutOfRange() {
+		std::string route_stops = MakeBase();
+		SetUint32(route_stops, ROUTE_STOPS_OFFSET + sizeof(uint32_t), 7);
+		std::string distances = MakeBase();
+		SetUint32(distances, DISTANCES_OFFSET, 9);
+		return Rejects(route_stops, "Invalid stop index"s) && Rejects(distances, "Invalid stop index"s);
+	}
+
+	// Ответы по базе, загруженной из двоичного файла, совпадают с ответами по исходному JSON
+	bool TestRoundTrip() {
+		std::ostringstream expected;
+		{
+			transport_catalogue::TransportCatalogue catalogue;
+			transport_catalogue::JsonReader reader(catalogue);
+			reader.ParseInput("{\"base_requests\": "s + BASE_REQUESTS + ", "s + SECTIONS + "}"s);
+			reader.PrintOutput(expected);
+		}
+
+		std::ostringstream actual;
+		{
+			transport_catalogue::TransportCatalogue catalogue;
+			std::istringstream base(MakeBase());
+			base_binary::LoadBase(base, catalogue);
+			transport_catalogue::JsonReader reader(catalogue);
+			reader.ParseInput("{"s + SECTIONS + "}"s);
+			reader.PrintOutput(actual);
+		}
+		return !expected.str().empty() && expected.str() == actual.str();
+	}
+
+} // namespace
+
+int main() {
+	int failed = 0;
+	const auto check = [&failed](bool passed, const char* name) {
+		if (!passed) {
+			std::cerr << "FAILED: " << name << std::endl;
+			++failed;
+		}
+	};
+	check(TestWrongSignature(), "wrong signature");
+	check(TestWrongVersionAndByteOrder(), "wrong version and byte order");
+	check(TestTruncated(), "truncated base");
+	check(TestNonMonotonicOffsets(), "non-monotonic offsets");
+	check(TestStopIndexOutOfRange(), "stop index out of range");
+	check(TestRoundTrip(), "round trip");
+	if (failed == 0) {
+		std::cerr << "OK" << std::endl;
+	}
+	return failed == 0 ? 0 : 1;
+}
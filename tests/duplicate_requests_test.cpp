@@ -0,0 +1,125 @@
+// Проверка ответов на повторяющиеся запросы пакета: подстановка request_id и статистика.
+// Сборка и запуск из корня репозитория:
+//   g++ -std=c++17 -pthread -Isrc tests/duplicate_requests_test.cpp $(ls src/*.cpp | grep -v '/main.cpp') -o duplicate_requests_test
+//   ./duplicate_requests_test
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "json.h"
+#include "json_arena.h"
+#include "json_reader.h"
+#include "transport_catalogue.h"
+
+using namespace std::literals;
+
+namespace {
+
+	const std::string INPUT = R"({
+		"base_requests": [
+			{"type": "Stop", "name": "A", "latitude": 55.61, "longitude": 37.20, "road_distances": {"B": 1000}},
+			{"type": "Stop", "name": "B", "latitude": 55.62, "longitude": 37.21, "road_distances": {"C": 2000}},
+			{"type": "Stop", "name": "C", "latitude": 55.63, "longitude": 37.22, "road_distances": {}},
+			{"type": "Bus", "name": "1", "stops": ["A", "B", "C"], "is_roundtrip": false}
+		],
+		"routing_settings": {"bus_wait_time": 6, "bus_velocity": 40},
+		"stat_requests": []
+	})";
+
+	// Разные запросы, которые повторяются в пакете по кругу
+	const std::vector<std::string> DISTINCT_REQUESTS = {
+		R"("type": "Bus", "name": "1")",
+		R"("type": "Stop", "name": "B")",
+		R"("type": "Route", "from": "A", "to": "C")",
+		R"("type": "Route", "from": "C", "to": "A")",
+		R"("type": "Stop", "name": "Nope")",
+		R"("type": "Route", "from": "A", "to": "A")",
+		R"("type": "Bus", "name": "X")"
+	};
+	constexpr int ROUTE_REQUESTS_PER_ROUND = 3;
+
+	// Пакет больше нескольких частей по 256 запросов и больше окна вывода при двух потоках.
+	// Значения id разной длины проверяют подстановку в ответ первого из повторов
+	constexpr size_t REQUESTS_COUNT = 7 * 400;
+
+	std::string MakeRequest(size_t index) {
+		return "{\"id\": "s + std::to_string(index * index) + ", "s
+			+ DISTINCT_REQUESTS[index % DISTINCT_REQUESTS.size()] + "}"s;
+	}
+
+	json::Document PrintResponses(const transport_catalogue::JsonReader& reader, const std::string& stat_requests) {
+		const json::arena::Document requests = json::arena::Load(stat_requests);
+		std::ostringstream output;
+		reader.PrintResponses(requests.GetRoot().AsArray(), output);
+		return json::Load(output.str());
+	}
+
+	// Каждый ответ пакета совпадает с ответом на тот же запрос, заданный отдельно
+	bool TestSplicedResponses(const transport_catalogue::JsonReader& reader) {
+		std::string stat_requests = "["s;
+		for (size_t i = 0; i < REQUESTS_COUNT; ++i) {
+			stat_requests += (i > 0 ? ", "s : ""s) + MakeRequest(i);
+		}
+		stat_requests += "]"s;
+		const json::Document batch = PrintResponses(reader, stat_requests);
+		const json::Array& responses = batch.GetRoot().AsArray();
+		if (responses.size() != REQUESTS_COUNT) {
+			return false;
+		}
+
+		transport_catalogue::TransportCatalogue catalogue;
+		transport_catalogue::JsonReader single_reader(catalogue);
+		single_reader.ParseInput(INPUT);
+		single_reader.SetCacheCapacity(0);
+		for (size_t i = 0; i < REQUESTS_COUNT; ++i) {
+			const json::Document single = PrintResponses(single_reader, "["s + MakeRequest(i) + "]"s);
+			if (!(responses[i] == single.GetRoot().AsArray().front())) {
+				std::cerr << "Response " << i << " differs" << std::endl;
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Повторы учитываются в статистике как отдельные ответы
+	bool TestStatsCountDuplicates(const transport_catalogue::JsonReader& reader) {
+		std::ostringstream output;
+		reader.PrintStats(output);
+		const json::Document stats = json::Load(output.str());
+		const json::Dict& requests = stats.GetRoot().AsMap().at("requests"s).AsMap();
+		int count = 0;
+		for (const auto& [type, latency] : requests) {
+			count += latency.AsMap().at("count"s).AsInt();
+		}
+		const int rounds = static_cast<int>(REQUESTS_COUNT / DISTINCT_REQUESTS.size());
+		return count == static_cast<int>(REQUESTS_COUNT)
+			&& requests.at("Route"s).AsMap().at("count"s).AsInt() == rounds * ROUTE_REQUESTS_PER_ROUND
+			&& stats.GetRoot().AsMap().at("routing"s).AsMap().at("routes_found"s).AsInt()
+				== rounds * ROUTE_REQUESTS_PER_ROUND;
+	}
+
+} // namespace
+
+int main() {
+	transport_catalogue::TransportCatalogue catalogue;
+	transport_catalogue::JsonReader reader(catalogue);
+	reader.ParseInput(INPUT);
+	reader.SetThreadsCount(2);
+	reader.EnableStats();
+
+	int failed = 0;
+	const auto check = [&failed](bool passed, const char* name) {
+		if (!passed) {
+			std::cerr << "FAILED: " << name << std::endl;
+			++failed;
+		}
+	};
+	check(TestSplicedResponses(reader), "spliced responses");
+	check(TestStatsCountDuplicates(reader), "stats count duplicates");
+	if (failed == 0) {
+		std::cerr << "OK" << std::endl;
+	}
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+// Проверка обработки ошибочных входных данных.
+// Сборка и запуск из корня репозитория:
+//   g++ -std=c++17 -pthread -Isrc tests/input_errors_test.cpp $(ls src/*.cpp | grep -v '/main.cpp') -o input_errors_test
+//   ./input_errors_test
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "json_reader.h"
+#include "transport_catalogue.h"
+
+using namespace std::literals;
+
+namespace {
+
+	const std::string SETTINGS = R"(
+		"render_settings": {}, "routing_settings": {"bus_wait_time": 6, "bus_velocity": 40},
+		"stat_requests": [])";
+
+	const std::string STOP_A = R"({"type": "Stop", "name": "A", "latitude": 55.6, "longitude": 37.2, "road_distances": {}})";
+
+	// true, если разбор base_requests завершился исключением с fragment в сообщении
+	template <typename Exception>
+	bool Rejects(const std::string& base_requests, const std::string& fragment) {
+		const std::string input = "{\"base_requests\": ["s + base_requests + "], "s + SETTINGS + "}"s;
+		transport_catalogue::TransportCatalogue catalogue;
+		transport_catalogue::JsonReader reader(catalogue);
+		try {
+			reader.ParseInput(input);
+		}
+		catch (const Exception& e) {
+			return std::string(e.what()).find(fragment) != std::string::npos;
+		}
+		return false;
+	}
+
+	// Маршрут через остановку, которая нигде не описана, отклоняется исключением
+	bool TestBusWithUnknownStop(bool is_pending) {
+		const std::string bus = R"({"type": "Bus", "name": "1", "stops": ["A", "Nope"], "is_roundtrip": true})";
+		// Маршрут до описания своих остановок обрабатывается после base_requests
+		return Rejects<std::out_of_range>(is_pending ? bus + ", "s + STOP_A : STOP_A + ", "s + bus, "Nope"s);
+	}
+
+	// Обязательные поля запросов нельзя пропустить или задать значением другого типа
+	bool TestMissingFields() {
+		return Rejects<std::invalid_argument>(R"({"type": "Stop", "name": "B", "longitude": 37.2})", "latitude"s)
+			&& Rejects<std::invalid_argument>(R"({"type": "Stop", "latitude": 55.6, "longitude": 37.2})", "name"s)
+			&& Rejects<std::invalid_argument>(R"({"name": "B", "latitude": 55.6, "longitude": 37.2})", "type"s)
+			&& Rejects<std::invalid_argument>(R"({"type": "Stop", "name": "B", "latitude": "55.6", "longitude": 37.2})", "latitude"s)
+			&& Rejects<std::invalid_argument>(STOP_A + R"(, {"type": "Bus", "name": "1", "stops": ["A"]})", "is_roundtrip"s)
+			&& Rejects<std::invalid_argument>(STOP_A + R"(, {"type": "Bus", "name": "1", "stops": ["A", 1], "is_roundtrip": true})", "stops"s);
+	}
+
+	bool TestInvalidRoadDistances() {
+		return Rejects<std::invalid_argument>(
+			R"({"type": "Stop", "name": "B", "latitude": 55.6, "longitude": 37.2, "road_distances": {"A": "x"}})", "road_distances"s)
+			&& Rejects<std::invalid_argument>(
+				R"({"type": "Stop", "name": "B", "latitude": 55.6, "longitude": 37.2, "road_distances": ["A"]})", "road_distances"s);
+	}
+
+} // namespace
+
+int main() {
+	int failed = 0;
+	const auto check = [&failed](bool passed, const char* name) {
+		if (!passed) {
+			std::cerr << "FAILED: " << name << std::endl;
+			++failed;
+		}
+	};
+	check(TestBusWithUnknownStop(false), "bus with unknown stop");
+	check(TestBusWithUnknownStop(true), "pending bus with unknown stop");
+	check(TestMissingFields(), "missing fields");
+	check(TestInvalidRoadDistances(), "invalid road distances");
+	if (failed == 0) {
+		std::cerr << "OK" << std::endl;
+	}
+	return failed == 0 ? 0 : 1;
+}